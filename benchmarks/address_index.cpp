@@ -0,0 +1,76 @@
+// Turns addresses inside a library's functions back into symbol names, with
+// dladdr and with address_index, one address at a time and in batches.
+
+#include <random>
+#include <vector>
+
+#include <reiji/address_index.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <dlfcn.h>
+#endif
+
+#include "bench.hpp"
+
+namespace {
+
+constexpr std::size_t lookups = 1 << 20;
+constexpr std::size_t batch   = 64;
+constexpr int runs            = 5;
+
+}   // namespace
+
+int main() {
+    reiji::unique_shared_lib lib {bench::plugin_path};
+    using function_table = int (*const[bench::plugin_function_count])();
+    auto functions = lib.get_symbol<function_table>("function_table");
+
+    // Addresses a few bytes into random functions, like return addresses in
+    // a stack trace would be
+    std::mt19937 random {42};
+    std::uniform_int_distribution<std::size_t> pick {
+        0, bench::plugin_function_count - 1};
+    std::vector<const void*> addresses(lookups);
+    for (auto& address : addresses) {
+        auto f  = reinterpret_cast<const char*>(functions[pick(random)]);
+        address = f + 2;
+    }
+
+    auto build_start = bench::clock::now();
+    reiji::address_index index {lib};
+    bench::report("building the index (" + std::to_string(index.size())
+                      + " symbols)",
+                  bench::seconds_since(build_start) * 1e6, "us");
+
+    auto per_lookup = [](double seconds) { return seconds * 1e9 / lookups; };
+
+#if defined(__unix__) || defined(__APPLE__)
+    bench::report("dladdr", per_lookup(bench::best_of(runs, [&] {
+                      ::Dl_info info;
+                      for (auto address : addresses) {
+                          ::dladdr(address, &info);
+                          bench::keep(info.dli_sname);
+                      }
+                  })),
+                  "ns/lookup");
+#endif
+
+    bench::report("address_index::lookup", per_lookup(bench::best_of(runs, [&] {
+                      for (auto address : addresses) {
+                          bench::keep(index.lookup(address).name);
+                      }
+                  })),
+                  "ns/lookup");
+
+    std::vector<reiji::address_info> results(batch);
+    bench::report("address_index::lookup, " + std::to_string(batch)
+                      + " at a time",
+                  per_lookup(bench::best_of(runs, [&] {
+                      for (std::size_t i = 0; i < lookups; i += batch) {
+                          index.lookup(&addresses[i], batch, results.data());
+                          bench::keep(results[0].name);
+                      }
+                  })),
+                  "ns/lookup");
+}
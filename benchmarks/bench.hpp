@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+#include "repeat.hpp"
+#include "temp_dir.hpp"
+
+// Small helpers shared by the benchmarks. Each benchmark is a plain program
+// that prints one line per measurement, so runs can be compared by diffing
+// their output.
+namespace bench {
+
+namespace fs = std::filesystem;
+
+using clock = std::chrono::steady_clock;
+
+// The library built from bench_plugin.cpp, and the names it exports
+inline const fs::path plugin_path {REIJI_BENCH_PLUGIN};
+inline const char* const plugin_functions[] = {
+    REIJI_REPEAT_1000(REIJI_NAME_OF, f_)};
+constexpr std::size_t plugin_function_count = 1000;
+
+inline const void* volatile sink;
+
+// Stores into a volatile, so the compiler can't drop the work that computed
+// value
+template <typename T>
+void keep(const T& value) {
+    sink = &value;
+}
+
+inline double seconds_since(clock::time_point start) {
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// Runs f (which does one batch of work) a few times, and returns how long the
+// fastest run took, in seconds
+template <typename F>
+double best_of(int runs, F&& f) {
+    auto best = 0.0;
+    for (int i = 0; i < runs; ++i) {
+        auto start   = clock::now();
+        f();
+        auto elapsed = seconds_since(start);
+        best         = i == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+inline void report(const std::string& what, double value, const char* unit) {
+    std::printf("%-56s %12.2f %s\n", what.c_str(), value, unit);
+}
+
+inline void note(const char* message) {
+    std::printf("# %s\n", message);
+}
+
+// count copies of the plugin under dir, each of which the loader treats as a
+// library of its own
+inline std::vector<fs::path> copy_plugin(const fs::path& dir, int count) {
+    std::vector<fs::path> copies;
+    for (int i = 0; i < count; ++i) {
+        auto copy = dir
+                    / ("plugin" + std::to_string(i)
+                       + plugin_path.extension().string());
+        fs::copy_file(plugin_path, copy, fs::copy_options::overwrite_existing);
+        copies.push_back(std::move(copy));
+    }
+    return copies;
+}
+
+// Drops a file from the page cache, so that the next read of it has to go to
+// the disk. Returns false where that isn't supported, the file is mapped by
+// somebody, or it has unwritten changes, so syncing first is up to the
+// caller.
+inline bool evict_from_page_cache(const fs::path& path) {
+#if defined(__linux__)
+    auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    auto ok = ::fdatasync(fd) == 0
+              && ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    ::close(fd);
+    return ok;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+inline bool evict_from_page_cache(const std::vector<fs::path>& paths) {
+    auto ok = true;
+    for (auto& path : paths) {
+        ok = evict_from_page_cache(path) && ok;
+    }
+    return ok;
+}
+
+// Like best_of, but drops files from the page cache before every run
+template <typename F>
+double best_of_cold(int runs, const std::vector<fs::path>& files, F&& f) {
+    auto best = 0.0;
+    for (int i = 0; i < runs; ++i) {
+        evict_from_page_cache(files);
+        auto start   = clock::now();
+        f();
+        auto elapsed = seconds_since(start);
+        best         = i == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+}   // namespace bench
@@ -0,0 +1,37 @@
+#include "export.hpp"
+#include "repeat.hpp"
+
+#include <map>
+#include <string>
+
+// Stands in for a real plugin: a thousand exported functions, a table of
+// pointers to them for the loader to relocate, and some global state that
+// gets built when the library is loaded and torn down when it's unloaded
+
+namespace {
+
+struct plugin_state {
+    plugin_state() {
+        // Nothing that would give the library STB_GNU_UNIQUE symbols (like
+        // std::to_string does), as glibc never unloads those
+        for (int i = 0; i < 500; ++i) {
+            entries[i] = std::string(static_cast<std::size_t>(i % 64), 'x');
+        }
+    }
+
+    std::map<int, std::string> entries;
+} state;
+
+}   // namespace
+
+extern "C" {
+
+#define REIJI_DEFINE_FUNCTION(name)                                            \
+    EXPORT int name() { return static_cast<int>(state.entries.size()) + 1; }
+REIJI_REPEAT_1000(REIJI_DEFINE_FUNCTION, f_)
+
+#define REIJI_ADDRESS_OF(name) &name,
+extern EXPORT int (*const function_table[1000])();
+int (*const function_table[1000])() = {
+    REIJI_REPEAT_1000(REIJI_ADDRESS_OF, f_)};
+}
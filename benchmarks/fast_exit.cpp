@@ -0,0 +1,122 @@
+// Shuts down a process that has plenty of plugins loaded: normally, in fast
+// exit mode, and in fast exit mode followed by std::quick_exit. Times both the
+// destruction of the libraries and everything from there to the process being
+// gone, which includes the static destructors a normal exit() still runs for
+// libraries that were left loaded.
+//
+// The process wide numbers come from running this program again in a child
+// process (with --child <mode>), so they're only measured on POSIX systems.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <reiji/fast_exit.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+constexpr int plugin_count = 128;
+constexpr int symbols_each = 50;
+
+enum class mode { normal, fast_exit, quick_exit };
+const char* const mode_names[] = {"normal", "fast_exit", "quick_exit"};
+
+struct loaded {
+    std::vector<reiji::unique_shared_lib> libs;
+    std::vector<reiji::symbol<int()>> symbols;
+};
+
+void load(loaded& l, const std::vector<bench::fs::path>& plugins) {
+    for (auto& plugin : plugins) {
+        l.libs.emplace_back(plugin);
+        l.libs.back().set_leak_on_exit(true);
+        for (int i = 0; i < symbols_each; ++i) {
+            l.symbols.push_back(l.libs.back().get_symbol<int()>(
+                bench::plugin_functions[i]));
+        }
+    }
+}
+
+// Seconds it takes to get rid of l
+double tear_down(loaded& l, mode how) {
+    reiji::set_fast_exit(how != mode::normal);
+    auto start = bench::clock::now();
+    l.libs.clear();
+    return bench::seconds_since(start);
+}
+
+// The child: loads the plugins, reports when it starts shutting down, and
+// exits the way it was asked to
+int child(const char* dir, mode how) {
+    loaded l;
+    std::vector<bench::fs::path> plugins;
+    for (int i = 0; i < plugin_count; ++i) {
+        plugins.push_back(bench::fs::path {dir}
+                          / ("plugin" + std::to_string(i)
+                             + bench::plugin_path.extension().string()));
+    }
+    load(l, plugins);
+
+    std::printf("%lld\n",
+                static_cast<long long>(
+                    bench::clock::now().time_since_epoch().count()));
+    std::fflush(stdout);
+    tear_down(l, how);
+    if (how == mode::quick_exit) {
+        std::quick_exit(0);
+    }
+    return 0;
+}
+
+}   // namespace
+
+int main(int argc, char** argv) {
+    if (argc == 4 && std::strcmp(argv[1], "--child") == 0) {
+        for (int m = 0; m < 3; ++m) {
+            if (std::strcmp(argv[3], mode_names[m]) == 0) {
+                return child(argv[2], static_cast<mode>(m));
+            }
+        }
+        return 1;
+    }
+
+    temp_dir dir {"reiji-bench-fast-exit-"};
+    auto plugins = bench::copy_plugin(dir.path, plugin_count);
+    auto label   = std::to_string(plugin_count) + " plugins, ";
+
+    // Libraries leaked by the fast exit run stay loaded, so that one goes
+    // last
+    for (auto how : {mode::normal, mode::fast_exit}) {
+        loaded l;
+        load(l, plugins);
+        auto name = mode_names[static_cast<int>(how)];
+        bench::report(label + "destroying them, " + name,
+                      tear_down(l, how) * 1e3, "ms");
+    }
+    reiji::set_fast_exit(false);
+
+#if defined(__unix__) || defined(__APPLE__)
+    for (int m = 0; m < 3; ++m) {
+        auto command = "'" + std::string {argv[0]} + "' --child '"
+                       + dir.path.string() + "' " + mode_names[m];
+        auto child = ::popen(command.c_str(), "r");
+        long long shutdown_started = 0;
+        if (not child || std::fscanf(child, "%lld", &shutdown_started) != 1) {
+            bench::note("couldn't run the child process");
+            return 1;
+        }
+        ::pclose(child);
+        auto elapsed = bench::clock::now().time_since_epoch()
+                       - bench::clock::duration {shutdown_started};
+        bench::report(label + "shutting down the process, " + mode_names[m],
+                      std::chrono::duration<double, std::milli> {elapsed}
+                          .count(),
+                      "ms");
+    }
+#endif
+}
@@ -0,0 +1,87 @@
+// Looks up every function the benchmark plugin exports, by plain name (which
+// goes through dlsym) and by pre-hashed name (which probes .gnu.hash directly)
+
+#include <cstring>
+#include <vector>
+
+#include <reiji/hashed_name.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <dlfcn.h>
+#endif
+
+#include "bench.hpp"
+
+namespace {
+
+constexpr int rounds = 200;
+constexpr int runs   = 5;
+
+}   // namespace
+
+int main() {
+    using namespace reiji::literals;
+
+    reiji::unique_shared_lib lib {bench::plugin_path};
+
+    // Hashing at runtime once is what "f_123"_sym boils down to
+    std::vector<reiji::hashed_name> hashed;
+    for (auto name : bench::plugin_functions) {
+        hashed.emplace_back(name, std::strlen(name));
+    }
+    auto missing = "reiji_no_such_symbol"_sym;
+
+    constexpr auto lookups = rounds * bench::plugin_function_count;
+    auto per_lookup = [](double seconds) { return seconds * 1e9 / lookups; };
+
+#if defined(__unix__) || defined(__APPLE__)
+    auto handle = ::dlopen(bench::plugin_path.c_str(), RTLD_NOW);
+    bench::report("dlsym", per_lookup(bench::best_of(runs, [&] {
+                      for (int i = 0; i < rounds; ++i) {
+                          for (auto name : bench::plugin_functions) {
+                              bench::keep(::dlsym(handle, name));
+                          }
+                      }
+                  })),
+                  "ns/lookup");
+    ::dlclose(handle);
+#endif
+
+    bench::report("get_symbol(const char*)",
+                  per_lookup(bench::best_of(runs, [&] {
+                      for (int i = 0; i < rounds; ++i) {
+                          for (auto name : bench::plugin_functions) {
+                              bench::keep(lib.get_symbol<int()>(name));
+                          }
+                      }
+                  })),
+                  "ns/lookup");
+
+    bench::report("get_symbol(hashed_name)",
+                  per_lookup(bench::best_of(runs, [&] {
+                      for (int i = 0; i < rounds; ++i) {
+                          for (auto& name : hashed) {
+                              bench::keep(lib.get_symbol<int()>(name));
+                          }
+                      }
+                  })),
+                  "ns/lookup");
+
+    bench::report("get_symbol(const char*), missing",
+                  per_lookup(bench::best_of(runs, [&] {
+                      for (std::size_t i = 0; i < lookups; ++i) {
+                          bench::keep(
+                              lib.get_symbol<int()>("reiji_no_such_symbol"));
+                      }
+                  })),
+                  "ns/lookup");
+
+    bench::report("get_symbol(hashed_name), missing",
+                  per_lookup(bench::best_of(runs, [&] {
+                      for (std::size_t i = 0; i < lookups; ++i) {
+                          bench::keep(lib.get_symbol<int()>(missing));
+                      }
+                  })),
+                  "ns/lookup");
+}
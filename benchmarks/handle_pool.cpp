@@ -0,0 +1,59 @@
+// Opens and closes libraries over and over, straight through the loader and
+// through handle_pools of different capacities
+
+#include <string>
+#include <vector>
+
+#include <reiji/handle_pool.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+constexpr int cycles = 1024;
+constexpr int runs   = 5;
+
+// Opens the libraries round robin, calling into each so that the open isn't
+// for nothing
+template <typename Open>
+void churn(const std::vector<bench::fs::path>& libraries, Open&& open) {
+    for (int i = 0; i < cycles; ++i) {
+        auto lib = open(libraries[i % libraries.size()]);
+        bench::keep(lib.template get_symbol<int()>("f_500")());
+    }
+}
+
+}   // namespace
+
+int main() {
+    temp_dir dir {"reiji-bench-handle-pool-"};
+    auto plugins = bench::copy_plugin(dir.path, 16);
+
+    auto per_cycle = [](double seconds) { return seconds * 1e6 / cycles; };
+
+    for (std::size_t count : {1, 16}) {
+        std::vector<bench::fs::path> libraries(plugins.begin(),
+                                               plugins.begin() + count);
+        auto label = std::to_string(count) + " libraries, ";
+
+        bench::report(label + "no pool", per_cycle(bench::best_of(runs, [&] {
+                          churn(libraries, [](const bench::fs::path& path) {
+                              return reiji::unique_shared_lib {path};
+                          });
+                      })),
+                      "us/cycle");
+
+        for (std::size_t capacity : {std::size_t {4}, count}) {
+            reiji::handle_pool pool {capacity};
+            bench::report(label + "pool of " + std::to_string(capacity),
+                          per_cycle(bench::best_of(runs, [&] {
+                              churn(libraries,
+                                    [&](const bench::fs::path& path) {
+                                        return pool.open(path);
+                                    });
+                          })),
+                          "us/cycle");
+        }
+    }
+}
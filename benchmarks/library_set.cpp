@@ -0,0 +1,94 @@
+// Finds symbols across several libraries, with library_set and with a loop
+// asking each library in turn, for different numbers of libraries and shares
+// of names that some library actually exports.
+//
+// The hits are all exported by the last library, so that every lookup has to
+// get past all the others first.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <reiji/library_set.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+#if defined(__APPLE__)
+constexpr auto lib1_name = "liblib1.dylib";
+#elif defined(_WIN32)
+constexpr auto lib1_name = "lib1.dll";
+#else
+constexpr auto lib1_name = "liblib1.so";
+#endif
+
+constexpr std::size_t queries = 1024;
+constexpr int runs            = 5;
+
+std::vector<std::string> make_queries(double hit_ratio) {
+    const char* hits[] = {"bar", "increase_bar_and_return_it", "table"};
+    std::mt19937 random {42};
+    std::bernoulli_distribution is_hit {hit_ratio};
+    std::vector<std::string> names;
+    for (std::size_t i = 0; i < queries; ++i) {
+        names.push_back(is_hit(random) ? hits[i % 3]
+                                       : "no_such_symbol_" + std::to_string(i));
+    }
+    return names;
+}
+
+}   // namespace
+
+int main() {
+    temp_dir dir {"reiji-bench-library-set-"};
+    auto plugins = bench::copy_plugin(dir.path, 63);
+    auto lib1    = bench::fs::path {REIJI_TEST_LIB_DIR} / lib1_name;
+
+    auto per_query = [](double seconds) { return seconds * 1e9 / queries; };
+
+    for (std::size_t count : {1, 8, 64}) {
+        reiji::library_set set;
+        std::vector<reiji::unique_shared_lib> libs;
+        for (std::size_t i = 0; i + 1 < count; ++i) {
+            set.add(reiji::unique_shared_lib {plugins[i]});
+            libs.emplace_back(plugins[i]);
+        }
+        set.add(reiji::unique_shared_lib {lib1});
+        libs.emplace_back(lib1);
+
+        for (auto hit_ratio : {0.0, 0.5, 1.0}) {
+            auto names = make_queries(hit_ratio);
+            // The hashes would normally come from "name"_sym
+            std::vector<reiji::hashed_name> hashed;
+            for (auto& name : names) {
+                hashed.emplace_back(name.c_str(), name.size());
+            }
+
+            auto label = std::to_string(count) + " libraries, "
+                         + std::to_string(static_cast<int>(hit_ratio * 100))
+                         + "% hits, ";
+            bench::report(label + "one library at a time",
+                          per_query(bench::best_of(runs, [&] {
+                              for (auto& name : names) {
+                                  for (auto& lib : libs) {
+                                      auto sym =
+                                          lib.get_symbol<int>(name.c_str());
+                                      if (sym.is_valid()) {
+                                          break;
+                                      }
+                                  }
+                              }
+                          })),
+                          "ns/query");
+            bench::report(label + "library_set",
+                          per_query(bench::best_of(runs, [&] {
+                              for (auto& name : hashed) {
+                                  bench::keep(set.find_first<int>(name));
+                              }
+                          })),
+                          "ns/query");
+        }
+    }
+}
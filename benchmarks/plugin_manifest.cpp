@@ -0,0 +1,87 @@
+// Finds the plugins in a directory that export a given name: by scanning
+// every file, with a manifest that has to be built first (cold), and with one
+// saved by an earlier run (warm). Each is timed with a warm page cache and
+// with the files dropped from it.
+//
+// Usage: bench_plugin_manifest [directory]
+// See bench_prefetch for why the directory matters.
+
+#include <cstdlib>   // std::exit
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+#include <reiji/plugin_manifest.hpp>
+#include <reiji/plugin_scanner.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+constexpr int plugin_count = 256;
+constexpr int runs         = 5;
+
+}   // namespace
+
+int main(int argc, char** argv) {
+    temp_dir dir {"reiji-bench-manifest-",
+                  argc > 1 ? bench::fs::path {argv[1]}
+                           : bench::fs::temp_directory_path()};
+    auto plugin_dir = dir.path / "plugins";
+    bench::fs::create_directory(plugin_dir);
+    auto files = bench::copy_plugin(plugin_dir, plugin_count);
+    for (int i = 0; i < 16; ++i) {
+        auto readme = plugin_dir / ("README" + std::to_string(i));
+        std::ofstream {readme} << "not a library\n";
+        files.push_back(readme);
+    }
+    if (not bench::evict_from_page_cache(files)) {
+        bench::note("can't evict files from the page cache here, the cold "
+                    "numbers are really warm ones");
+    }
+
+    auto cache = dir.path / "manifest";
+    files.push_back(cache);
+
+    const std::vector<std::string> required {"f_500"};
+    auto expect = [](std::size_t found) {
+        if (found != plugin_count) {
+            bench::note("found the wrong number of plugins");
+            std::exit(1);
+        }
+    };
+
+    auto scan = [&] {
+        expect(reiji::find_plugins(plugin_dir, required).size());
+    };
+    auto cold_manifest = [&] {
+        std::error_code ec;
+        bench::fs::remove(cache, ec);
+        reiji::plugin_manifest manifest {cache};
+        manifest.refresh(plugin_dir);
+        manifest.save();
+        expect(manifest.find_plugins(required).size());
+    };
+    auto warm_manifest = [&] {
+        reiji::plugin_manifest manifest {cache};
+        if (manifest.refresh(plugin_dir) != 0) {
+            manifest.save();
+        }
+        expect(manifest.find_plugins(required).size());
+    };
+
+    auto label = std::to_string(plugin_count) + " plugins, ";
+    bench::report(label + "scanning, warm cache",
+                  bench::best_of(runs, scan) * 1e3, "ms");
+    bench::report(label + "scanning, cold cache",
+                  bench::best_of_cold(runs, files, scan) * 1e3, "ms");
+    bench::report(label + "cold manifest, warm cache",
+                  bench::best_of(runs, cold_manifest) * 1e3, "ms");
+    bench::report(label + "cold manifest, cold cache",
+                  bench::best_of_cold(runs, files, cold_manifest) * 1e3, "ms");
+    cold_manifest();
+    bench::report(label + "warm manifest, warm cache",
+                  bench::best_of(runs, warm_manifest) * 1e3, "ms");
+    bench::report(label + "warm manifest, cold cache",
+                  bench::best_of_cold(runs, files, warm_manifest) * 1e3, "ms");
+}
@@ -0,0 +1,91 @@
+// Opens a directory's worth of plugins with a cold page cache, with and
+// without prefetching them first.
+//
+// Usage: bench_prefetch [directory]
+// The plugins are copied to a scratch directory inside directory (the
+// system's temporary directory by default), which should be on a disk rather
+// than in memory for the cold numbers to mean anything.
+
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <reiji/prefetch.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+constexpr int plugin_count = 64;
+constexpr int runs         = 5;
+// Stands in for whatever else the program does while starting up
+constexpr std::chrono::milliseconds other_work {20};
+
+enum class strategy { none, prefetch, prefetch_async };
+
+double open_all(const std::vector<bench::fs::path>& plugins, strategy how) {
+    auto start = bench::clock::now();
+
+    std::vector<std::future<std::vector<bench::fs::path>>> pending;
+    if (how == strategy::prefetch) {
+        for (auto& plugin : plugins) {
+            bench::keep(reiji::prefetch(plugin).size());
+        }
+    } else if (how == strategy::prefetch_async) {
+        for (auto& plugin : plugins) {
+            pending.push_back(reiji::prefetch_async(plugin));
+        }
+        std::this_thread::sleep_for(other_work);
+    }
+
+    std::vector<reiji::unique_shared_lib> libs;
+    for (auto& plugin : plugins) {
+        libs.emplace_back(plugin);
+        bench::keep(libs.back().get_symbol<int()>("f_500")());
+    }
+    for (auto& p : pending) {
+        p.wait();
+    }
+
+    auto elapsed = bench::seconds_since(start);
+    if (how == strategy::prefetch_async) {
+        elapsed -= std::chrono::duration<double>(other_work).count();
+    }
+    return elapsed;
+}
+
+}   // namespace
+
+int main(int argc, char** argv) {
+    temp_dir dir {"reiji-bench-prefetch-",
+                  argc > 1 ? bench::fs::path {argv[1]}
+                           : bench::fs::temp_directory_path()};
+    auto plugins = bench::copy_plugin(dir.path, plugin_count);
+
+    if (not bench::evict_from_page_cache(plugins)) {
+        bench::note("can't evict files from the page cache here, the cold "
+                    "numbers are really warm ones");
+    }
+
+    auto cold = [&](strategy how) {
+        auto best = 0.0;
+        for (int i = 0; i < runs; ++i) {
+            bench::evict_from_page_cache(plugins);
+            auto elapsed = open_all(plugins, how);
+            best         = i == 0 ? elapsed : std::min(best, elapsed);
+        }
+        return best * 1e3;
+    };
+
+    auto label = std::to_string(plugin_count) + " plugins, ";
+    bench::report(label + "warm cache", bench::best_of(runs, [&] {
+                      open_all(plugins, strategy::none);
+                  }) * 1e3,
+                  "ms");
+    bench::report(label + "cold cache", cold(strategy::none), "ms");
+    bench::report(label + "cold cache, prefetch first",
+                  cold(strategy::prefetch), "ms");
+    bench::report(label + "cold cache, prefetch during other work",
+                  cold(strategy::prefetch_async), "ms");
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+// REIJI_REPEAT_1000(f, p) expands to f(p000) f(p001) ... f(p999), which is
+// how the benchmarks get a thousand distinct symbols without spelling them out
+#define REIJI_REPEAT_10(f, p)                                                  \
+    f(p##0) f(p##1) f(p##2) f(p##3) f(p##4) f(p##5) f(p##6) f(p##7) f(p##8)    \
+        f(p##9)
+#define REIJI_REPEAT_100(f, p)                                                 \
+    REIJI_REPEAT_10(f, p##0)                                                   \
+    REIJI_REPEAT_10(f, p##1)                                                   \
+    REIJI_REPEAT_10(f, p##2)                                                   \
+    REIJI_REPEAT_10(f, p##3)                                                   \
+    REIJI_REPEAT_10(f, p##4)                                                   \
+    REIJI_REPEAT_10(f, p##5)                                                   \
+    REIJI_REPEAT_10(f, p##6)                                                   \
+    REIJI_REPEAT_10(f, p##7)                                                   \
+    REIJI_REPEAT_10(f, p##8)                                                   \
+    REIJI_REPEAT_10(f, p##9)
+#define REIJI_REPEAT_1000(f, p)                                                \
+    REIJI_REPEAT_100(f, p##0)                                                  \
+    REIJI_REPEAT_100(f, p##1)                                                  \
+    REIJI_REPEAT_100(f, p##2)                                                  \
+    REIJI_REPEAT_100(f, p##3)                                                  \
+    REIJI_REPEAT_100(f, p##4)                                                  \
+    REIJI_REPEAT_100(f, p##5)                                                  \
+    REIJI_REPEAT_100(f, p##6)                                                  \
+    REIJI_REPEAT_100(f, p##7)                                                  \
+    REIJI_REPEAT_100(f, p##8)                                                  \
+    REIJI_REPEAT_100(f, p##9)
+
+// The names of the functions above, as a string array initializer
+#define REIJI_STRINGIFY(x) #x
+#define REIJI_NAME_OF(x)   REIJI_STRINGIFY(x),
@@ -0,0 +1,74 @@
+// Looks up a thousand functions in a static_module, and the same thousand
+// names in the benchmark plugin loaded as a shared library
+
+#include <cstring>
+#include <vector>
+
+#include <reiji/hashed_name.hpp>
+#include <reiji/static_module.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+constexpr int rounds = 200;
+constexpr int runs   = 5;
+
+#define REIJI_DEFINE_FUNCTION(name)                                            \
+    int name() { return 1; }
+REIJI_REPEAT_1000(REIJI_DEFINE_FUNCTION, f_)
+
+#define REIJI_STATIC_SYMBOL(name) {#name, &name},
+const reiji::static_symbol symbols[] = {
+    REIJI_REPEAT_1000(REIJI_STATIC_SYMBOL, f_)};
+
+reiji::static_module module {"bench_static_module", symbols};
+
+}   // namespace
+
+int main() {
+    std::vector<reiji::hashed_name> hashed;
+    for (auto name : bench::plugin_functions) {
+        hashed.emplace_back(name, std::strlen(name));
+    }
+
+    constexpr auto lookups = rounds * bench::plugin_function_count;
+    auto per_lookup = [](double seconds) { return seconds * 1e9 / lookups; };
+
+    auto by_name = [&](reiji::unique_shared_lib& lib) {
+        return per_lookup(bench::best_of(runs, [&] {
+            for (int i = 0; i < rounds; ++i) {
+                for (auto name : bench::plugin_functions) {
+                    bench::keep(lib.get_symbol<int()>(name));
+                }
+            }
+        }));
+    };
+    auto by_hash = [&](reiji::unique_shared_lib& lib) {
+        return per_lookup(bench::best_of(runs, [&] {
+            for (int i = 0; i < rounds; ++i) {
+                for (auto& name : hashed) {
+                    bench::keep(lib.get_symbol<int()>(name));
+                }
+            }
+        }));
+    };
+
+    reiji::unique_shared_lib dynamic {bench::plugin_path};
+    reiji::unique_shared_lib fixed {"bench_static_module"};
+    if (not dynamic.get_symbol<int()>("f_000")
+        || not fixed.get_symbol<int()>("f_000")) {
+        bench::note("couldn't look anything up");
+        return 1;
+    }
+
+    bench::report("shared library, get_symbol(const char*)", by_name(dynamic),
+                  "ns/lookup");
+    bench::report("shared library, get_symbol(hashed_name)", by_hash(dynamic),
+                  "ns/lookup");
+    bench::report("static module, get_symbol(const char*)", by_name(fixed),
+                  "ns/lookup");
+    bench::report("static module, get_symbol(hashed_name)", by_hash(fixed),
+                  "ns/lookup");
+}
@@ -0,0 +1,70 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uintptr_t, std::uint32_t
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace reiji {
+
+class unique_shared_lib;
+
+// What an address_index knows about an address. A default constructed one
+// (empty name, null symbol_address) means the address isn't inside any symbol
+struct address_info {
+    std::string_view name;
+    const void* symbol_address {nullptr};
+    std::size_t size {0};
+
+    explicit operator bool() const noexcept { return symbol_address; }
+};
+
+// Maps addresses inside a loaded library back to the exported symbol they
+// belong to, e.g. for symbolizing samples from a profiler. Built once from the
+// library's dynamic symbol table, after which lookups are a binary search over
+// a flat, sorted array of start addresses and never call into the loader.
+//
+// Unlike dladdr, an address only matches a symbol if it falls inside the
+// symbol's [start, start + size) range, rather than whatever symbol precedes
+// it. Names are copied into the index, so it can outlive the library (the
+// addresses it knows about just stop meaning anything).
+//
+// Only ELF platforms are supported, elsewhere the index is always empty.
+class address_index final {
+public:
+    address_index() noexcept = default;
+    explicit address_index(const unique_shared_lib& lib);
+
+    [[nodiscard]] address_info lookup(const void* address) const noexcept;
+
+    // Looks up count addresses at once, writing to results[0..count). Faster
+    // than calling lookup in a loop, as searches for a group of addresses are
+    // interleaved with one another.
+    void lookup(const void* const* addresses,
+                std::size_t count,
+                address_info* results) const noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return _starts.size(); }
+    [[nodiscard]] bool empty() const noexcept { return _starts.empty(); }
+
+private:
+    std::size_t _find(std::uintptr_t address) const noexcept;
+    address_info _info(std::size_t index,
+                       std::uintptr_t address) const noexcept;
+
+    // Parallel arrays sorted by start address, so that the binary search only
+    // ever touches _starts
+    std::vector<std::uintptr_t> _starts;
+    std::vector<std::uintptr_t> _sizes;
+    std::vector<std::uint32_t> _name_offsets;
+    std::string _names;
+    std::uintptr_t _end {0};
+};
+
+}   // namespace reiji
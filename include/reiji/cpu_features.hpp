@@ -0,0 +1,113 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uint32_t
+#include <filesystem>
+#include <vector>
+
+#include <reiji/flags.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+namespace reiji {
+
+namespace fs = std::filesystem;
+
+enum cpu_features : std::uint32_t {};
+
+#define REIJI_RAW(x) (static_cast<std::uint32_t>(x))
+
+constexpr cpu_features operator|(cpu_features lhs, cpu_features rhs) noexcept {
+    return cpu_features {REIJI_RAW(lhs) | REIJI_RAW(rhs)};
+}
+
+constexpr cpu_features operator&(cpu_features lhs, cpu_features rhs) noexcept {
+    return cpu_features {REIJI_RAW(lhs) & REIJI_RAW(rhs)};
+}
+
+constexpr cpu_features operator~(cpu_features f) noexcept {
+    return cpu_features {~REIJI_RAW(f)};
+}
+
+constexpr cpu_features& operator|=(cpu_features& lhs,
+                                   cpu_features rhs) noexcept {
+    lhs = lhs | rhs;
+    return lhs;
+}
+
+#undef REIJI_RAW
+
+namespace cpu {
+
+constexpr static auto none = cpu_features {0};
+
+// x86 features, only ever detected on x86 (and only if the OS saves the
+// registers they use)
+constexpr static auto sse3     = cpu_features {1u << 0};
+constexpr static auto ssse3    = cpu_features {1u << 1};
+constexpr static auto sse4_1   = cpu_features {1u << 2};
+constexpr static auto sse4_2   = cpu_features {1u << 3};
+constexpr static auto popcnt   = cpu_features {1u << 4};
+constexpr static auto avx      = cpu_features {1u << 5};
+constexpr static auto avx2     = cpu_features {1u << 6};
+constexpr static auto bmi1     = cpu_features {1u << 7};
+constexpr static auto bmi2     = cpu_features {1u << 8};
+constexpr static auto f16c     = cpu_features {1u << 9};
+constexpr static auto fma      = cpu_features {1u << 10};
+constexpr static auto lzcnt    = cpu_features {1u << 11};
+constexpr static auto movbe    = cpu_features {1u << 12};
+constexpr static auto avx512f  = cpu_features {1u << 13};
+constexpr static auto avx512bw = cpu_features {1u << 14};
+constexpr static auto avx512cd = cpu_features {1u << 15};
+constexpr static auto avx512dq = cpu_features {1u << 16};
+constexpr static auto avx512vl = cpu_features {1u << 17};
+
+// The x86-64 psABI microarchitecture levels, minus the features every x86-64
+// CPU we could be built for has anyway (CMPXCHG16B, LAHF/SAHF, XSAVE)
+constexpr static auto x86_64_v2 = sse3 | ssse3 | sse4_1 | sse4_2 | popcnt;
+constexpr static auto x86_64_v3 =
+    x86_64_v2 | avx | avx2 | bmi1 | bmi2 | f16c | fma | lzcnt | movbe;
+constexpr static auto x86_64_v4 =
+    x86_64_v3 | avx512f | avx512bw | avx512cd | avx512dq | avx512vl;
+
+}   // namespace cpu
+
+// What the CPU we're running on supports, detected on the first call
+[[nodiscard]] cpu_features detected_cpu_features() noexcept;
+
+// One build of a library, and the features it was compiled to make use of
+struct library_variant {
+    fs::path path;
+    cpu_features required;
+};
+
+struct variant_choice {
+    unique_shared_lib library;
+    // Index of the variant that got opened, or the number of variants if
+    // none could be
+    std::size_t index;
+};
+
+// Opens the variant that requires the most features out of those the CPU
+// supports, earlier variants winning ties. If it fails to open the next best
+// one is tried, and so on. When none of them open, index says so and library
+// holds the error from the last attempt, if there was one.
+[[nodiscard]] variant_choice
+open_best_variant(const std::vector<library_variant>& variants,
+                  flags_type flags);
+[[nodiscard]] inline variant_choice
+open_best_variant(const std::vector<library_variant>& variants) {
+    return open_best_variant(variants, detail::default_flags);
+}
+// Like the above, but choosing for a CPU supporting available rather than the
+// one we're running on
+[[nodiscard]] variant_choice
+open_best_variant(const std::vector<library_variant>& variants,
+                  flags_type flags,
+                  cpu_features available);
+
+}   // namespace reiji
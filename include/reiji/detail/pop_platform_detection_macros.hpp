@@ -7,3 +7,4 @@
 
 #undef REIJI_PLATFORM_WINDOWS
 #undef REIJI_PLATFORM_POSIX
+#undef REIJI_PLATFORM_ELF
@@ -15,3 +15,11 @@
 #else
 #    error "Unsupported platform. (Maybe send a PR?)"
 #endif
+
+// Whether shared libraries on this platform are ELF files, which some of our
+// features need to look inside of
+#if REIJI_PLATFORM_POSIX && !defined(__APPLE__)
+#    define REIJI_PLATFORM_ELF 1
+#else
+#    define REIJI_PLATFORM_ELF 0
+#endif
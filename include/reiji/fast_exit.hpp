@@ -0,0 +1,39 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <vector>
+
+#include <reiji/unique_shared_lib.hpp>
+
+namespace reiji {
+
+// Fast exit mode is for processes on their way out. While it is on, closing
+// (or destroying) a library that was marked with set_leak_on_exit(true) still
+// invalidates its symbols, but leaves the library loaded instead of calling
+// dlclose/FreeLibrary. The OS takes care of the memory once the process is
+// gone.
+//
+// Note that a normal exit() still runs the static destructors of every
+// library left loaded (glibc does so from _dl_fini), so leaking on its own
+// only moves that work. Processes that want to skip it entirely should end
+// with std::quick_exit or _exit once whatever needs flushing is flushed.
+//
+// Libraries that aren't marked are closed as usual. Those whose teardown has
+// to happen in a particular order are best closed explicitly with
+// close_in_order before the rest of the process winds down.
+//
+// The switch is process wide and may be flipped from any thread.
+void set_fast_exit(bool enabled) noexcept;
+[[nodiscard]] bool fast_exit_enabled() noexcept;
+
+// Closes libraries one after the other, in the order given, with
+// close_mode::immediate. Libraries marked with set_leak_on_exit(true) are
+// closed as well, since asking for them by name is asking for their teardown.
+// Errors end up in each library's last_error().
+void close_in_order(const std::vector<unique_shared_lib*>& libraries);
+
+}   // namespace reiji
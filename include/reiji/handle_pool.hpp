@@ -0,0 +1,90 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>   // std::size_t
+#include <filesystem>
+#include <memory>   // std::shared_ptr
+#include <string>
+
+#include <reiji/flags.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+namespace reiji {
+
+namespace fs = std::filesystem;
+
+namespace detail {
+class handle_pool_state;
+}   // namespace detail
+
+// Keeps libraries loaded after they get closed, so that opening them again is
+// a hash table lookup rather than a trip through the platform loader.
+//
+// Libraries opened through a pool hand their handle back to it when they are
+// closed (or destroyed). Up to capacity() libraries that nobody uses anymore
+// are kept loaded, and past that the least recently used ones get closed for
+// real, honoring the close mode of whoever released them last. That holds for
+// libraries pushed out by set_capacity or by the pool going away too.
+//
+// Since a pooled library may never actually be unloaded, its static
+// constructors and destructors don't run on every open and close, and its
+// global state carries over from one user to the next. That's the whole
+// point, but it does mean libraries that rely on being freshly loaded
+// shouldn't be pooled.
+//
+// Libraries are pooled by the name and flags they were opened with, so opening
+// the same library through different names shares a single handle but needs a
+// trip through the loader for each name.
+//
+// A pool may be used from several threads at once.
+class handle_pool final {
+public:
+    explicit handle_pool(std::size_t capacity);
+
+    handle_pool(const handle_pool&) = delete;
+    handle_pool& operator=(const handle_pool&) = delete;
+
+    handle_pool(handle_pool&&) noexcept = default;
+    handle_pool& operator=(handle_pool&&) noexcept = default;
+
+    // Closes every idle library. Libraries still in use get closed normally
+    // once they are done with, rather than being kept.
+    ~handle_pool() noexcept;
+
+    [[nodiscard]] unique_shared_lib open(const char* filename) {
+        return open(fs::path {filename}, detail::default_flags);
+    }
+    [[nodiscard]] unique_shared_lib open(const char* filename,
+                                         flags_type flags) {
+        return open(fs::path {filename}, flags);
+    }
+    [[nodiscard]] unique_shared_lib open(const std::string& filename) {
+        return open(fs::path {filename}, detail::default_flags);
+    }
+    [[nodiscard]] unique_shared_lib open(const std::string& filename,
+                                         flags_type flags) {
+        return open(fs::path {filename}, flags);
+    }
+    [[nodiscard]] unique_shared_lib open(const fs::path& path) {
+        return open(path, detail::default_flags);
+    }
+    [[nodiscard]] unique_shared_lib open(const fs::path& path,
+                                         flags_type flags);
+
+    // Shrinking the capacity closes the least recently used idle libraries
+    // right away
+    void set_capacity(std::size_t capacity);
+    [[nodiscard]] std::size_t capacity() const;
+
+    // How many libraries are loaded only because the pool keeps them around
+    [[nodiscard]] std::size_t idle() const;
+
+private:
+    std::shared_ptr<detail::handle_pool_state> _state;
+};
+
+}   // namespace reiji
@@ -0,0 +1,68 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uint32_t
+
+namespace reiji {
+
+namespace detail {
+
+// The hash function used by ELF's DT_GNU_HASH sections
+constexpr std::uint32_t gnu_hash(const char* s, std::size_t len) noexcept {
+    std::uint32_t h = 5381;
+    for (std::size_t i = 0; i < len; ++i) {
+        h = h * 33 + static_cast<unsigned char>(s[i]);
+    }
+    return h;
+}
+
+// Length of the string in a char array, which stops at the first null
+// character rather than trusting the array's size, and never reads past it
+template <std::size_t N>
+constexpr std::size_t array_string_length(const char (&s)[N]) noexcept {
+    std::size_t len = 0;
+    while (len < N && s[len] != '\0') {
+        ++len;
+    }
+    return len;
+}
+
+}   // namespace detail
+
+// A symbol name that carries its own GNU hash, so that looking it up doesn't
+// need to hash it (or even find its length) again. Names known at compile time
+// should be written as `constexpr auto name = "foo"_sym;` (or passed directly
+// as "foo"_sym, where optimizing compilers fold the hash anyway).
+//
+// name must be null terminated, which string literals always are.
+struct hashed_name {
+    constexpr hashed_name(const char* name, std::size_t length) noexcept
+        : name {name}, length {length}, hash {detail::gnu_hash(name, length)} {}
+
+    // Arrays aren't necessarily string literals, a buffer filled in at runtime
+    // usually holds a shorter string than it has room for, so the length is
+    // measured rather than taken from N. It still folds for literals.
+    template <std::size_t N>
+    constexpr hashed_name(const char (&name)[N]) noexcept
+        : hashed_name {name, detail::array_string_length(name)} {}
+
+    const char* name;
+    std::size_t length;
+    std::uint32_t hash;
+};
+
+namespace literals {
+
+constexpr hashed_name operator""_sym(const char* name,
+                                     std::size_t length) noexcept {
+    return hashed_name {name, length};
+}
+
+}   // namespace literals
+
+}   // namespace reiji
@@ -0,0 +1,88 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <reiji/flags.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+namespace reiji {
+
+namespace fs = std::filesystem;
+
+// How a library_resolver finds out that its cached directory listings went
+// stale
+enum class resolver_invalidation {
+    // Only through library_resolver::invalidate
+    manual,
+    // Additionally watch the search directories with inotify, picking up
+    // changes on the next resolve. Behaves like manual on non Linux platforms
+    watch,
+};
+
+// Finds shared libraries by bare name (e.g. "foo") in an ordered list of
+// directories, using the platform's naming rules (libfoo.so, libfoo.dylib or
+// foo.dll). Directory listings are read once and cached, so resolving a name
+// doesn't touch the filesystem until the cache gets invalidated.
+//
+// For every directory, in order, the first match out of: the name exactly as
+// given, the name with the platform's prefix and suffix added, and the name
+// with only the suffix added, wins. Only regular files and symlinks to them
+// count as matches. Names that contain a directory are not searched for, and
+// are returned unchanged.
+class library_resolver final {
+public:
+    explicit library_resolver(
+        std::vector<fs::path> search_dirs,
+        resolver_invalidation invalidation = resolver_invalidation::manual);
+
+    library_resolver(const library_resolver&) = delete;
+    library_resolver& operator=(const library_resolver&) = delete;
+
+    ~library_resolver() noexcept;
+
+    [[nodiscard]] std::optional<fs::path> resolve(std::string_view name);
+
+    // Opens the resolved path, or hands name to the platform loader as is if
+    // it couldn't be resolved, so that last_error() says something useful
+    [[nodiscard]] unique_shared_lib open(std::string_view name) {
+        return open(name, detail::default_flags);
+    }
+    [[nodiscard]] unique_shared_lib open(std::string_view name,
+                                         flags_type flags);
+
+    // Drop the cached listing of every directory, or just of dir
+    void invalidate();
+    void invalidate(const fs::path& dir);
+
+    [[nodiscard]] const std::vector<fs::path>& search_dirs() const noexcept {
+        return _search_dirs;
+    }
+
+private:
+    struct directory {
+        std::unordered_set<std::string> entries;
+        bool listed {false};
+        int watch {-1};
+    };
+
+    void _read_watch_events();
+    void _list(std::size_t index);
+
+    std::vector<fs::path> _search_dirs;
+    std::vector<directory> _dirs;   // parallel to _search_dirs
+    std::mutex _mutex;
+    int _inotify_fd {-1};
+};
+
+}   // namespace reiji
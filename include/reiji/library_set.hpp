@@ -0,0 +1,101 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uint64_t
+#include <cstring>   // std::strlen
+#include <memory>    // std::unique_ptr
+#include <vector>
+
+#include <reiji/hashed_name.hpp>
+#include <reiji/symbol.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+namespace reiji {
+
+// Owns a group of libraries and answers "which of them defines this symbol?".
+//
+// Members are searched from highest to lowest precedence, and in the order
+// they were added when precedences are equal. Only symbols a member defines
+// itself are considered, not ones it gets from its dependencies.
+//
+// Every member gets a bloom filter of the names it exports, built the first
+// time it is searched (and again after it gets reopened), so that members which
+// don't define a name are skipped after a single memory access, without
+// calling into the loader or touching their last_error(). Only ELF platforms
+// get filters, elsewhere every member is asked.
+class library_set final {
+public:
+    library_set() = default;
+
+    library_set(const library_set&) = delete;
+    library_set& operator=(const library_set&) = delete;
+
+    library_set(library_set&&) noexcept = default;
+    library_set& operator=(library_set&&) noexcept = default;
+
+    // Returns a reference to the member, which stays valid until it's removed
+    unique_shared_lib& add(unique_shared_lib lib, int precedence = 0);
+    // Closes and removes lib, returns false if it isn't a member
+    bool remove(const unique_shared_lib& lib) noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return _members.size(); }
+    [[nodiscard]] bool empty() const noexcept { return _members.empty(); }
+
+    template <typename T>
+    [[nodiscard]] symbol<T> find_first(const hashed_name& name) {
+        for (auto& m : _members) {
+            if (auto sym = _lookup(m, name)) {
+                return m.lib->_make_symbol<T>(name.name, sym);
+            }
+        }
+        return symbol<T> {};
+    }
+    template <typename T>
+    [[nodiscard]] symbol<T> find_first(const char* name) {
+        return find_first<T>(hashed_name {name, std::strlen(name)});
+    }
+
+    template <typename T>
+    [[nodiscard]] std::vector<symbol<T>> find_all(const hashed_name& name) {
+        std::vector<symbol<T>> symbols;
+        for (auto& m : _members) {
+            if (auto sym = _lookup(m, name)) {
+                symbols.push_back(m.lib->_make_symbol<T>(name.name, sym));
+            }
+        }
+        return symbols;
+    }
+    template <typename T>
+    [[nodiscard]] std::vector<symbol<T>> find_all(const char* name) {
+        return find_all<T>(hashed_name {name, std::strlen(name)});
+    }
+
+    // The member find_first would take name from, or nullptr
+    [[nodiscard]] unique_shared_lib* provider(const hashed_name& name);
+    [[nodiscard]] unique_shared_lib* provider(const char* name) {
+        return provider(hashed_name {name, std::strlen(name)});
+    }
+
+private:
+    struct member {
+        std::unique_ptr<unique_shared_lib> lib;
+        int precedence;
+        // What the filter was built from, kept alive so that a reopened
+        // member can't end up with an image at the same address
+        std::shared_ptr<const detail::loaded_image> image;
+        // Empty means "might export anything"
+        std::vector<std::uint64_t> bloom;
+    };
+
+    static void _index(member& m);
+    static void* _lookup(member& m, const hashed_name& name);
+
+    std::vector<member> _members;
+};
+
+}   // namespace reiji
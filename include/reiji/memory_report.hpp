@@ -0,0 +1,62 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uintptr_t
+#include <vector>
+
+namespace reiji {
+
+// Sizes in bytes, with the same meaning as the fields of the same name in
+// /proc/<pid>/smaps
+struct memory_usage {
+    std::size_t size {0};
+    std::size_t rss {0};
+    std::size_t pss {0};
+    std::size_t shared_clean {0};
+    std::size_t shared_dirty {0};
+    std::size_t private_clean {0};
+    std::size_t private_dirty {0};
+    std::size_t swap {0};
+
+    memory_usage& operator+=(const memory_usage& other) noexcept {
+        size += other.size;
+        rss += other.rss;
+        pss += other.pss;
+        shared_clean += other.shared_clean;
+        shared_dirty += other.shared_dirty;
+        private_clean += other.private_clean;
+        private_dirty += other.private_dirty;
+        swap += other.swap;
+        return *this;
+    }
+};
+
+// One PT_LOAD segment of a loaded library. [start, end) is rounded out to
+// whole pages, the way the segment is mapped.
+struct segment_usage {
+    std::uintptr_t start {0};
+    std::uintptr_t end {0};
+    bool readable {false};
+    bool writable {false};
+    bool executable {false};
+    memory_usage usage;
+};
+
+// Only filled in on Linux, elsewhere (and for libraries that aren't open)
+// there are no segments and the total is all zeroes
+struct memory_report {
+    std::vector<segment_usage> segments;
+    memory_usage total;
+};
+
+// What all the libraries currently opened through reiji cost together, found
+// with a single pass over /proc/self/smaps. Libraries opened more than once are
+// only counted once.
+[[nodiscard]] memory_usage open_libraries_memory_usage();
+
+}   // namespace reiji
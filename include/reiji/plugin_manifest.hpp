@@ -0,0 +1,97 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uint32_t, std::uint64_t, std::int64_t
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace reiji {
+
+namespace fs = std::filesystem;
+
+// What a plugin_manifest knows about one file
+struct manifest_entry {
+    fs::path path;
+    std::uint64_t size {0};
+    // fs::last_write_time, in file_time_type ticks
+    std::int64_t mtime {0};
+    // False for files that turned out not to be shared libraries we could
+    // load, which are remembered so that they don't get parsed again
+    bool is_library {false};
+    // Hex encoded, empty if the library has no build-id note
+    std::string build_id;
+    // The names the library's dynamic symbol table defines, sorted and each
+    // followed by a NUL, with export_offsets saying where each one starts.
+    // Libraries can export tens of thousands of names, and keeping them in
+    // one block is what makes loading a manifest cheap.
+    std::string export_names;
+    std::vector<std::uint32_t> export_offsets;
+    // DT_NEEDED entries, in order
+    std::vector<std::string> needed;
+
+    [[nodiscard]] bool exports(std::string_view name) const;
+    [[nodiscard]] std::size_t export_count() const noexcept {
+        return export_offsets.size();
+    }
+    [[nodiscard]] std::string_view export_name(std::size_t i) const {
+        return export_names.c_str() + export_offsets[i];
+    }
+};
+
+// A cache of what find_plugins would learn by parsing every file in a
+// directory, kept on disk between runs.
+//
+// Loading a manifest is a single read of the cache file. refresh() only stats
+// the files in a directory, and parses the ones that are new or whose size or
+// modification time changed since they were last seen, so with a warm
+// manifest nothing gets opened at all until a plugin is actually needed.
+//
+// The cache file is meant for the machine that wrote it: it isn't portable
+// between platforms, and a file that can't be read (or was written by a
+// different version of the format) just makes for an empty manifest.
+class plugin_manifest final {
+public:
+    // An empty manifest that save() writes to cache_file. Whatever
+    // cache_file holds is loaded, if it's a manifest.
+    explicit plugin_manifest(fs::path cache_file);
+
+    // Brings the entries for files in directory up to date, dropping those
+    // for files that are gone. Returns how many entries were added, updated
+    // or removed.
+    std::size_t refresh(const fs::path& directory);
+
+    // Replaces the cache file, returns false on failure. The old file stays
+    // as it was if writing the new one fails.
+    bool save() const;
+
+    // Sorted by path
+    [[nodiscard]] const std::vector<manifest_entry>& entries() const noexcept {
+        return _entries;
+    }
+    [[nodiscard]] const manifest_entry* find(const fs::path& path) const;
+
+    // What find_plugins would return for every directory refreshed so far.
+    // On platforms where we can't look inside shared libraries that's every
+    // file with the platform's shared library extension.
+    [[nodiscard]] std::vector<fs::path>
+    find_plugins(const std::vector<std::string>& required_exports) const;
+
+    [[nodiscard]] const fs::path& cache_file() const noexcept {
+        return _cache_file;
+    }
+
+private:
+    void _load();
+
+    fs::path _cache_file;
+    std::vector<manifest_entry> _entries;
+};
+
+}   // namespace reiji
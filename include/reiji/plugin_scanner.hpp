@@ -0,0 +1,83 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <array>
+#include <cstddef>   // std::size_t
+#include <filesystem>
+#include <string>
+#include <tuple>
+#include <utility>   // std::index_sequence
+#include <vector>
+
+#include <reiji/flags.hpp>
+#include <reiji/symbol.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+namespace reiji {
+
+namespace fs = std::filesystem;
+
+// A library found by load_plugins, together with the symbols it was required
+// to export, in the order they were asked for
+template <typename... Ts>
+struct plugin {
+    fs::path path;
+    unique_shared_lib library;
+    std::tuple<symbol<Ts>...> symbols;
+};
+
+// Returns the files in directory whose dynamic symbol table defines every name
+// in required_exports, sorted by path. The files are only parsed, not loaded,
+// so none of their static constructors or dependencies run. Candidates are
+// checked in parallel.
+//
+// On platforms where we can't look inside shared libraries this returns every
+// file with the platform's shared library extension instead.
+std::vector<fs::path>
+find_plugins(const fs::path& directory,
+             const std::vector<std::string>& required_exports);
+
+namespace detail {
+
+template <typename... Ts, std::size_t... Is>
+bool bind_plugin_symbols(plugin<Ts...>& p,
+                         const std::array<const char*, sizeof...(Ts)>& names,
+                         std::index_sequence<Is...>) {
+    p.symbols = std::tuple<symbol<Ts>...> {
+        p.library.template get_symbol<Ts>(names[Is])...};
+    return (std::get<Is>(p.symbols).is_valid() && ...);
+}
+
+}   // namespace detail
+
+// Opens every library find_plugins accepts and binds the named symbols, e.g.
+//
+//     auto plugins = reiji::load_plugins<int(), const char*>(
+//         dir, {"plugin_init", "plugin_name"});
+//
+// Libraries that fail to open, or whose symbols can't be bound after all, are
+// left out.
+template <typename... Ts>
+std::vector<plugin<Ts...>>
+load_plugins(const fs::path& directory,
+             const std::array<const char*, sizeof...(Ts)>& names,
+             flags_type flags = detail::default_flags) {
+    std::vector<plugin<Ts...>> plugins;
+    for (auto& path :
+         find_plugins(directory, {names.begin(), names.end()})) {
+        auto& p = plugins.emplace_back();
+        p.path  = path;
+        p.library.open(path, flags);
+        if (not detail::bind_plugin_symbols(
+                p, names, std::index_sequence_for<Ts...> {})) {
+            plugins.pop_back();
+        }
+    }
+    return plugins;
+}
+
+}   // namespace reiji
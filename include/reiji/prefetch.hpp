@@ -0,0 +1,32 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <filesystem>
+#include <future>
+#include <vector>
+
+namespace reiji {
+
+namespace fs = std::filesystem;
+
+// Asks the kernel to start reading the shared library at path, along with
+// every library in its DT_NEEDED closure, into the page cache, so that a later
+// unique_shared_lib::open doesn't have to wait on lots of small reads from a
+// cold disk. Nothing gets loaded: dependencies are found by parsing the files
+// and searching DT_RPATH, LD_LIBRARY_PATH, DT_RUNPATH and the directories the
+// process already loaded libraries from, roughly as the dynamic loader would.
+// Libraries that are already loaded in the process are skipped.
+//
+// Returns the files for which readahead was requested. Only does something on
+// ELF platforms, elsewhere it returns an empty vector.
+std::vector<fs::path> prefetch(const fs::path& path);
+
+// Same as prefetch, but runs on a separate thread so the caller can get on with
+// other startup work in the meantime
+std::future<std::vector<fs::path>> prefetch_async(fs::path path);
+
+}   // namespace reiji
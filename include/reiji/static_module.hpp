@@ -0,0 +1,76 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>   // std::size_t
+#include <memory>    // std::unique_ptr
+#include <type_traits>
+
+namespace reiji {
+
+namespace detail {
+struct static_module_table;
+}   // namespace detail
+
+// One entry in the symbol table of a statically linked module
+struct static_symbol {
+    template <typename T>
+    static_symbol(const char* symbol_name, T* symbol_address) noexcept
+        : name {symbol_name},
+          address {const_cast<void*>(
+              reinterpret_cast<const volatile void*>(symbol_address))} {
+        if constexpr (not std::is_function_v<T>) {
+            size = sizeof(T);
+        }
+    }
+
+    const char* name;
+    void* address;
+    // 0 for functions
+    std::size_t size {0};
+};
+
+// Makes a statically linked module available under a library name, so that
+// opening that name gives a unique_shared_lib backed by the module's symbol
+// table instead of going through the platform loader. Code that loads symbols
+// works the same either way.
+//
+// Modules are meant to be registered by a namespace scope object in the
+// module itself, e.g.:
+//
+//     static const reiji::static_symbol symbols[] = {
+//         {"answer", &answer},
+//         {"compute", &compute},
+//     };
+//     static reiji::static_module module {"libcompute.so", symbols};
+//
+// Note that linkers drop object files nothing refers to from static libraries,
+// so something has to pull in the one defining the module.
+//
+// The symbol table gets a perfect hash when the module is registered, so
+// looking a hashed_name up costs one probe and one string comparison.
+// Opening a module makes no copy of name or symbols, both need to outlive
+// everything that uses the module.
+class static_module final {
+public:
+    template <std::size_t N>
+    static_module(const char* name, const static_symbol (&symbols)[N])
+        : static_module {name, symbols, N} {}
+    static_module(const char* name,
+                  const static_symbol* symbols,
+                  std::size_t count);
+
+    static_module(const static_module&) = delete;
+    static_module& operator=(const static_module&) = delete;
+
+    // Libraries that opened the module must be closed by now
+    ~static_module() noexcept;
+
+private:
+    std::unique_ptr<detail::static_module_table> _table;
+};
+
+}   // namespace reiji
@@ -31,8 +31,8 @@ protected:
 
     symbol_base& operator=(symbol_base&& other) noexcept {
         // Lack of self assignment protection is intentional
-        _uid    = std::exchange(other._uid, 0);
-        _origin = std::exchange(other._origin, nullptr);
+        remove_self_from_origins_symbol_vector();
+        _take_over(other);
         return *this;
     }
 
@@ -50,11 +50,7 @@ protected:
         }
     }
 
-    void swap(symbol_base& other) noexcept {
-        using std::swap;
-        swap(_uid, other._uid);
-        swap(_origin, other._origin);
-    }
+    void swap(symbol_base& other) noexcept;
 
     bool shares_origin_with(const symbol_base& other) const noexcept {
         return is_valid() && _origin == other._origin;
@@ -68,6 +64,11 @@ private:
         _origin = nullptr;
     }
 
+    // Our origin keeps a pointer to every live symbol, these keep it pointing
+    // at the right object when symbols get moved around
+    symbol_base** _slot_in_origin() noexcept;
+    void _take_over(symbol_base& other) noexcept;
+
     std::uint64_t _uid {0};
     reiji::unique_shared_lib* _origin {nullptr};
 };
@@ -208,6 +209,8 @@ public:
             return static_cast<symbol&>(
                 symbol_base::operator=(std::move(other)));
         }
+
+        return *this;
     }
 
     ~symbol() noexcept {
@@ -274,6 +277,251 @@ private:
     pointer _f {nullptr};
 };
 
+// A view over an exported array, e.g. `extern "C" const T table[]`. The
+// elements are used in place, and the size comes from the library's symbol
+// table, see unique_shared_lib::get_symbol.
+template <typename T>
+class symbol<T[]> final : private detail::symbol_base {
+public:
+    using element_type    = T;
+    using pointer         = element_type*;
+    using const_pointer   = const element_type*;
+    using reference       = element_type&;
+    using const_reference = const element_type&;
+    using size_type       = std::size_t;
+    using iterator        = pointer;
+    using const_iterator  = const_pointer;
+
+    symbol() noexcept = default;
+
+    symbol(const symbol&) = delete;
+    symbol& operator=(const symbol&) = delete;
+
+    symbol(symbol&& other) noexcept { *this = std::move(other); }
+
+    symbol& operator=(symbol&& other) noexcept {
+        if (this != &other) {
+            _ptr  = std::exchange(other._ptr, nullptr);
+            _size = std::exchange(other._size, 0);
+
+            return static_cast<symbol&>(
+                symbol_base::operator=(std::move(other)));
+        }
+
+        return *this;
+    }
+
+    ~symbol() noexcept {
+        symbol_base::remove_self_from_origins_symbol_vector();
+    }
+
+    reference operator[](size_type i) {
+        if (is_valid()) {
+            return _ptr[i];
+        } else {
+            REIJI_ON_INVALID_SYMBOL("reiji::symbol<T[]>::operator[]");
+        }
+    }
+
+    const_reference operator[](size_type i) const {
+        if (is_valid()) {
+            return _ptr[i];
+        } else {
+            REIJI_ON_INVALID_SYMBOL("reiji::symbol<T[]>::operator[] const");
+        }
+    }
+
+    pointer data() {
+        if (is_valid()) {
+            return _ptr;
+        } else {
+            REIJI_ON_INVALID_SYMBOL("reiji::symbol<T[]>::data");
+        }
+    }
+
+    const_pointer data() const {
+        if (is_valid()) {
+            return _ptr;
+        } else {
+            REIJI_ON_INVALID_SYMBOL("reiji::symbol<T[]>::data const");
+        }
+    }
+
+    iterator begin() { return data(); }
+    const_iterator begin() const { return data(); }
+    iterator end() { return data() + _size; }
+    const_iterator end() const { return data() + _size; }
+
+    size_type size() const noexcept { return is_valid() ? _size : 0; }
+    bool empty() const noexcept { return size() == 0; }
+
+    void swap(symbol& other) noexcept {
+        symbol_base::swap(other);
+        std::swap(_ptr, other._ptr);
+        std::swap(_size, other._size);
+    }
+
+    bool is_valid() const noexcept { return symbol_base::is_valid() && _ptr; }
+
+    template <typename U>
+    bool shares_origin_with(const symbol<U>& other) const noexcept {
+        return symbol_base::shares_origin_with(other);
+    }
+
+    explicit operator bool() const noexcept { return is_valid(); }
+
+    bool operator!() const noexcept { return not is_valid(); }
+
+    bool operator==(std::nullptr_t) const noexcept { return not _ptr; }
+
+    bool operator==(const symbol& rhs) const noexcept {
+        return symbol_base::shares_origin_with(rhs)
+               && symbol_base::compare(rhs) == 0;
+    }
+
+    bool operator<(const symbol& rhs) const noexcept {
+        return symbol_base::shares_origin_with(rhs)
+               && symbol_base::compare(rhs) == -1;
+    }
+
+    bool operator>(const symbol& rhs) const noexcept {
+        return symbol_base::shares_origin_with(rhs)
+               && symbol_base::compare(rhs) == 1;
+    }
+
+private:
+    friend class unique_shared_lib;
+
+    symbol(pointer ptr,
+           size_type size,
+           std::uint64_t uid,
+           unique_shared_lib* origin)
+        : symbol_base {uid, origin}, _ptr {ptr}, _size {size} {}
+
+    pointer _ptr {nullptr};
+    size_type _size {0};
+};
+
+// Like symbol<T[]>, but for arrays whose size is known up front. Where the
+// library's symbol table says how big the array is, get_symbol refuses arrays
+// smaller than N.
+template <typename T, std::size_t N>
+class symbol<T[N]> final : private detail::symbol_base {
+public:
+    using element_type    = T;
+    using pointer         = element_type*;
+    using const_pointer   = const element_type*;
+    using reference       = element_type&;
+    using const_reference = const element_type&;
+    using size_type       = std::size_t;
+    using iterator        = pointer;
+    using const_iterator  = const_pointer;
+
+    symbol() noexcept = default;
+
+    symbol(const symbol&) = delete;
+    symbol& operator=(const symbol&) = delete;
+
+    symbol(symbol&& other) noexcept { *this = std::move(other); }
+
+    symbol& operator=(symbol&& other) noexcept {
+        if (this != &other) {
+            _ptr = std::exchange(other._ptr, nullptr);
+
+            return static_cast<symbol&>(
+                symbol_base::operator=(std::move(other)));
+        }
+
+        return *this;
+    }
+
+    ~symbol() noexcept {
+        symbol_base::remove_self_from_origins_symbol_vector();
+    }
+
+    reference operator[](size_type i) {
+        if (is_valid()) {
+            return _ptr[i];
+        } else {
+            REIJI_ON_INVALID_SYMBOL("reiji::symbol<T[N]>::operator[]");
+        }
+    }
+
+    const_reference operator[](size_type i) const {
+        if (is_valid()) {
+            return _ptr[i];
+        } else {
+            REIJI_ON_INVALID_SYMBOL("reiji::symbol<T[N]>::operator[] const");
+        }
+    }
+
+    pointer data() {
+        if (is_valid()) {
+            return _ptr;
+        } else {
+            REIJI_ON_INVALID_SYMBOL("reiji::symbol<T[N]>::data");
+        }
+    }
+
+    const_pointer data() const {
+        if (is_valid()) {
+            return _ptr;
+        } else {
+            REIJI_ON_INVALID_SYMBOL("reiji::symbol<T[N]>::data const");
+        }
+    }
+
+    iterator begin() { return data(); }
+    const_iterator begin() const { return data(); }
+    iterator end() { return data() + N; }
+    const_iterator end() const { return data() + N; }
+
+    // Like symbol<T[]>, an invalid symbol views no elements at all
+    size_type size() const noexcept { return is_valid() ? N : 0; }
+    bool empty() const noexcept { return size() == 0; }
+
+    void swap(symbol& other) noexcept {
+        symbol_base::swap(other);
+        std::swap(_ptr, other._ptr);
+    }
+
+    bool is_valid() const noexcept { return symbol_base::is_valid() && _ptr; }
+
+    template <typename U>
+    bool shares_origin_with(const symbol<U>& other) const noexcept {
+        return symbol_base::shares_origin_with(other);
+    }
+
+    explicit operator bool() const noexcept { return is_valid(); }
+
+    bool operator!() const noexcept { return not is_valid(); }
+
+    bool operator==(std::nullptr_t) const noexcept { return not _ptr; }
+
+    bool operator==(const symbol& rhs) const noexcept {
+        return symbol_base::shares_origin_with(rhs)
+               && symbol_base::compare(rhs) == 0;
+    }
+
+    bool operator<(const symbol& rhs) const noexcept {
+        return symbol_base::shares_origin_with(rhs)
+               && symbol_base::compare(rhs) == -1;
+    }
+
+    bool operator>(const symbol& rhs) const noexcept {
+        return symbol_base::shares_origin_with(rhs)
+               && symbol_base::compare(rhs) == 1;
+    }
+
+private:
+    friend class unique_shared_lib;
+
+    symbol(pointer ptr, size_type, std::uint64_t uid, unique_shared_lib* origin)
+        : symbol_base {uid, origin}, _ptr {ptr} {}
+
+    pointer _ptr {nullptr};
+};
+
 template <typename T>
 bool operator==(std::nullptr_t, const symbol<T>& rhs) noexcept {
     return rhs == nullptr;
@@ -5,20 +5,40 @@
 
 #pragma once
 
-#include <cstddef>   // std::nullptr_t
+#include <cstddef>   // std::nullptr_t, std::size_t
 #include <cstdint>   // std::uint64_t
 #include <filesystem>
+#include <memory>   // std::shared_ptr
 #include <string>
+#include <type_traits>   // std::is_array_v, std::extent_v
 #include <vector>
 
 #include <reiji/detail/push_platform_detection_macros.hpp>
 #include <reiji/flags.hpp>
+#include <reiji/hashed_name.hpp>
+#include <reiji/memory_report.hpp>
 #include <reiji/symbol.hpp>
 
 namespace reiji {
 
 namespace fs = std::filesystem;
 
+namespace detail {
+struct loaded_image;
+class handle_pool_state;
+struct static_module_table;
+}   // namespace detail
+
+// Controls what close() does with the native handle. With close_mode::deferred
+// symbols are still invalidated right away, but the dlclose/FreeLibrary call
+// (and with it the library's static destructors) is handed off to a background
+// thread.
+enum class close_mode { immediate, deferred };
+
+class address_index;
+class handle_pool;
+class library_set;
+
 class unique_shared_lib {
 public:
     unique_shared_lib() = default;
@@ -64,43 +84,133 @@ public:
     void open(const fs::path& path) { open(path, detail::default_flags); }
     void open(const fs::path& path, flags_type flags);
 
-    void close();
+    void close() { close(_close_mode); }
+    void close(close_mode mode);
+
+    void set_close_mode(close_mode mode) noexcept { _close_mode = mode; }
+    [[nodiscard]] close_mode get_close_mode() const noexcept {
+        return _close_mode;
+    }
+
+    // Marks the library as safe to leave loaded at exit, see fast_exit.hpp.
+    // Carried over by moves and swaps, like the close mode.
+    void set_leak_on_exit(bool leak) noexcept { _leak_on_exit = leak; }
+    [[nodiscard]] bool leaks_on_exit() const noexcept { return _leak_on_exit; }
 
     void swap(unique_shared_lib& other);
 
+    // For array types (symbol<T[]> and symbol<T[N]>) the size of the array
+    // is taken from the symbol's size in the library's dynamic symbol table.
+    // That's only available on ELF platforms with glibc, elsewhere T[] can't
+    // be loaded and T[N] is taken on trust.
     template <typename T>
     [[nodiscard]] symbol<T> get_symbol(const char* symbol_name) {
-        return symbol<T> {reinterpret_cast<T*>(_get_symbol(symbol_name)),
-                          _next_uid(), this};
+        return _make_symbol<T>(symbol_name, _get_symbol(symbol_name));
     }
     template <typename T>
     [[nodiscard]] symbol<T> get_symbol(const std::string& symbol_name) {
         return get_symbol<T>(symbol_name.c_str());
     }
+    // On ELF platforms this looks the name up in the library's .gnu.hash
+    // section directly, skipping dlsym. Anything out of the ordinary (no
+    // single default version, an IFUNC, thread local, not defined by this
+    // library itself, ...) is still handed to dlsym.
+    template <typename T>
+    [[nodiscard]] symbol<T> get_symbol(const hashed_name& symbol_name) {
+        return _make_symbol<T>(symbol_name.name, _get_symbol(symbol_name));
+    }
+
+    // How much memory each of the library's segments takes up, read from
+    // /proc/self/smaps. Only supported on Linux, see memory_report.
+    [[nodiscard]] memory_report memory_footprint() const;
 
     [[nodiscard]] std::string last_error() const { return _error; }
 
 private:
     friend class detail::symbol_base;
+    friend class address_index;
+    friend class handle_pool;
+    friend class library_set;
+    friend void close_in_order(const std::vector<unique_shared_lib*>&);
 
     // It *should* be fine for these to be void* on all the platforms we
     // support, I think.
     using native_handle = void*;
     using native_symbol = void*;
 
+    template <typename T>
+    symbol<T> _make_symbol(const char* symbol_name, native_symbol sym) {
+        if constexpr (std::is_array_v<T>) {
+            using element_type = std::remove_extent_t<T>;
+            std::size_t count  = 0;
+            auto ptr           = _check_array_symbol(symbol_name, sym,
+                                           sizeof(element_type),
+                                           std::extent_v<T>, count);
+            return symbol<T> {reinterpret_cast<element_type*>(ptr), count,
+                              _next_uid(), this};
+        } else {
+            return symbol<T> {reinterpret_cast<T*>(sym), _next_uid(), this};
+        }
+    }
+
     [[nodiscard]] native_symbol _get_symbol(const char* symbol_name);
+    [[nodiscard]] native_symbol _get_symbol(const hashed_name& symbol_name);
+    // Only finds symbols defined by this library itself, and leaves _error
+    // alone when there's no such symbol
+    [[nodiscard]] native_symbol
+    _get_local_symbol(const hashed_name& symbol_name);
+
+    // Whether sym lies in this library's own image rather than in one of its
+    // dependencies. Says yes when the platform can't tell.
+    [[nodiscard]] bool _defines(native_symbol sym) const;
+
+    enum class gnu_hash_lookup { found, missing, unusual };
+    // Probes .gnu.hash, result says whether the symbol was found, whether
+    // it's definitely not defined by this library, or whether dlsym needs to
+    // be asked instead
+    [[nodiscard]] native_symbol _lookup_gnu_hash(const hashed_name& symbol_name,
+                                                 gnu_hash_lookup& result);
+    const detail::loaded_image* _loaded_image();
+    // extent is 0 for arrays of unknown bound, count receives the number of
+    // elements in the array
+    [[nodiscard]] native_symbol _check_array_symbol(const char* symbol_name,
+                                                    native_symbol sym,
+                                                    std::size_t element_size,
+                                                    std::size_t extent,
+                                                    std::size_t& count);
+    void _prune_symbols();
+    void _invalidate_symbols() noexcept;
+    // close() minus the fast exit check
+    void _unload(close_mode mode);
+    // Lets go of the library without unloading it
+    void _leak();
     std::uint64_t _next_uid() noexcept { return ++_curr_uid; }
 
     native_handle _handle {nullptr};
     std::uint64_t _curr_uid {0};
     std::string _error;
     std::vector<detail::symbol_base*> _symbols;
+    close_mode _close_mode {close_mode::immediate};
+    bool _leak_on_exit {false};
+    // Parsed lazily by the first hashed lookup
+    std::shared_ptr<const detail::loaded_image> _image;
+    // Set for libraries opened through a handle_pool, which close() gives the
+    // handle back to
+    std::shared_ptr<detail::handle_pool_state> _pool;
+    // Set instead of _handle when the name we were opened with belongs to a
+    // static_module
+    const detail::static_module_table* _static {nullptr};
 };
 
 inline void swap(unique_shared_lib& lhs, unique_shared_lib& rhs) noexcept {
     lhs.swap(rhs);
 }
 
+// Blocks until every handle closed with close_mode::deferred so far has
+// actually been unloaded. Meant to be called during shutdown, or whenever the
+// caller needs the libraries to be gone from the process.
+void drain_deferred_closes();
+
 }   // namespace reiji
 
 #include <reiji/detail/pop_platform_detection_macros.hpp>
@@ -0,0 +1,146 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+// clang-format off
+#include <reiji/address_index.hpp>
+#include <reiji/unique_shared_lib.hpp>
+#include "elf.hpp"
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#include <algorithm>   // std::sort, std::max
+#include <numeric>     // std::iota
+
+namespace reiji {
+
+address_index::address_index(const unique_shared_lib& lib) {
+#if REIJI_PLATFORM_ELF
+    detail::loaded_image image {lib._handle};
+    if (not image.valid()) {
+        return;
+    }
+
+    struct entry {
+        std::uintptr_t start;
+        std::uintptr_t size;
+        std::size_t index;
+        bool global;
+    };
+    std::vector<entry> entries;
+    for (std::size_t i = 1; i < image.symbol_count; ++i) {
+        auto& sym = image.symtab[i];
+        auto type = ELF64_ST_TYPE(sym.st_info);
+        if (not image.is_exported(i) || sym.st_shndx == SHN_ABS
+            || (type != STT_FUNC && type != STT_OBJECT
+                && type != STT_GNU_IFUNC)) {
+            continue;
+        }
+        entries.push_back({image.base + sym.st_value, sym.st_size, i,
+                           ELF64_ST_BIND(sym.st_info) == STB_GLOBAL});
+    }
+
+    // Aliases share a start address, keep the global one (if any) so the name
+    // we report is the "real" one
+    std::sort(entries.begin(), entries.end(), [](auto& lhs, auto& rhs) {
+        return lhs.start != rhs.start ? lhs.start < rhs.start
+                                      : lhs.global > rhs.global;
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](auto& lhs, auto& rhs) {
+                                  return lhs.start == rhs.start;
+                              }),
+                  entries.end());
+
+    _starts.reserve(entries.size());
+    _sizes.reserve(entries.size());
+    _name_offsets.reserve(entries.size());
+    for (auto& e : entries) {
+        _starts.push_back(e.start);
+        // Zero sized symbols (mostly hand written assembly) still own their
+        // first byte
+        _sizes.push_back(std::max<std::uintptr_t>(e.size, 1));
+        _name_offsets.push_back(static_cast<std::uint32_t>(_names.size()));
+        _names += image.strtab + image.symtab[e.index].st_name;
+        _names += '\0';
+        _end = std::max(_end, e.start + _sizes.back());
+    }
+#else
+    (void)lib;
+#endif
+}
+
+std::size_t address_index::_find(std::uintptr_t address) const noexcept {
+    // Branchless search for the last start <= address. The loop runs the same
+    // number of times for every address, which is what lets the batched
+    // lookup run several of these side by side.
+    const std::uintptr_t* base = _starts.data();
+    std::size_t n              = _starts.size();
+    while (n > 1) {
+        auto half = n / 2;
+        base      = base[half] <= address ? base + half : base;
+        n -= half;
+    }
+    return static_cast<std::size_t>(base - _starts.data());
+}
+
+address_info address_index::_info(std::size_t index,
+                                  std::uintptr_t address) const noexcept {
+    if (address - _starts[index] >= _sizes[index]) {
+        return {};
+    }
+    return {std::string_view {_names.data() + _name_offsets[index]},
+            reinterpret_cast<const void*>(_starts[index]), _sizes[index]};
+}
+
+address_info address_index::lookup(const void* address) const noexcept {
+    auto addr = reinterpret_cast<std::uintptr_t>(address);
+    if (_starts.empty() || addr < _starts.front() || addr >= _end) {
+        return {};
+    }
+    return _info(_find(addr), addr);
+}
+
+void address_index::lookup(const void* const* addresses,
+                           std::size_t count,
+                           address_info* results) const noexcept {
+    if (_starts.empty()) {
+        std::fill(results, results + count, address_info {});
+        return;
+    }
+
+    // Searching lanes addresses in lockstep gives the CPU that many
+    // independent loads to have in flight at every step, instead of one
+    // dependent chain of cache misses per address
+    constexpr std::size_t lanes = 8;
+    const auto first            = _starts.data();
+
+    for (std::size_t i = 0; i < count; i += lanes) {
+        auto group = std::min(lanes, count - i);
+
+        std::uintptr_t addr[lanes];
+        const std::uintptr_t* base[lanes];
+        for (std::size_t l = 0; l < group; ++l) {
+            addr[l] = reinterpret_cast<std::uintptr_t>(addresses[i + l]);
+            base[l] = first;
+        }
+
+        for (std::size_t n = _starts.size(); n > 1;) {
+            auto half = n / 2;
+            for (std::size_t l = 0; l < group; ++l) {
+                base[l] = base[l][half] <= addr[l] ? base[l] + half : base[l];
+            }
+            n -= half;
+        }
+
+        for (std::size_t l = 0; l < group; ++l) {
+            results[i + l] =
+                addr[l] < *first || addr[l] >= _end
+                    ? address_info {}
+                    : _info(static_cast<std::size_t>(base[l] - first), addr[l]);
+        }
+    }
+}
+
+}   // namespace reiji
@@ -0,0 +1,159 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#include <reiji/cpu_features.hpp>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)               \
+    || defined(_M_IX86)
+#    define REIJI_CPU_X86 1
+#    if defined(_MSC_VER)
+#        include <immintrin.h>   // _xgetbv
+#        include <intrin.h>      // __cpuid, __cpuidex
+#    else
+#        include <cpuid.h>
+#    endif
+#else
+#    define REIJI_CPU_X86 0
+#endif
+
+#include <algorithm>   // std::stable_sort
+#include <bitset>
+
+namespace reiji {
+
+namespace {
+
+#if REIJI_CPU_X86
+struct cpuid_registers {
+    std::uint32_t eax {0}, ebx {0}, ecx {0}, edx {0};
+};
+
+cpuid_registers cpuid(std::uint32_t leaf, std::uint32_t subleaf = 0) {
+    cpuid_registers r;
+#    if defined(_MSC_VER)
+    int regs[4];
+    __cpuidex(regs, static_cast<int>(leaf), static_cast<int>(subleaf));
+    r.eax = static_cast<std::uint32_t>(regs[0]);
+    r.ebx = static_cast<std::uint32_t>(regs[1]);
+    r.ecx = static_cast<std::uint32_t>(regs[2]);
+    r.edx = static_cast<std::uint32_t>(regs[3]);
+#    else
+    __cpuid_count(leaf, subleaf, r.eax, r.ebx, r.ecx, r.edx);
+#    endif
+    return r;
+}
+
+// The register state the OS saves on context switches
+std::uint64_t xgetbv0() {
+#    if defined(_MSC_VER)
+    return _xgetbv(0);
+#    else
+    std::uint32_t eax = 0, edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (std::uint64_t {edx} << 32) | eax;
+#    endif
+}
+
+constexpr bool bit(std::uint32_t reg, int n) noexcept {
+    return (reg >> n) & 1;
+}
+
+cpu_features detect() noexcept {
+    auto features = cpu::none;
+    auto set      = [&](bool present, cpu_features f) {
+        if (present) {
+            features |= f;
+        }
+    };
+
+    auto max_leaf = cpuid(0).eax;
+    if (max_leaf < 1) {
+        return features;
+    }
+
+    auto leaf1 = cpuid(1);
+    set(bit(leaf1.ecx, 0), cpu::sse3);
+    set(bit(leaf1.ecx, 9), cpu::ssse3);
+    set(bit(leaf1.ecx, 19), cpu::sse4_1);
+    set(bit(leaf1.ecx, 20), cpu::sse4_2);
+    set(bit(leaf1.ecx, 22), cpu::movbe);
+    set(bit(leaf1.ecx, 23), cpu::popcnt);
+
+    // AVX and up need the OS to save YMM (and for AVX-512 also opmask and
+    // ZMM) state, or using them will fault even though the CPU has them
+    auto xcr0    = bit(leaf1.ecx, 27) ? xgetbv0() : 0;
+    auto ymm     = (xcr0 & 0x6) == 0x6;
+    auto zmm     = (xcr0 & 0xe6) == 0xe6;
+    auto leaf7   = max_leaf >= 7 ? cpuid(7) : cpuid_registers {};
+    auto ext_max = cpuid(0x80000000).eax;
+    auto ext1    = ext_max >= 0x80000001 ? cpuid(0x80000001)
+                                         : cpuid_registers {};
+
+    set(ymm && bit(leaf1.ecx, 28), cpu::avx);
+    set(ymm && bit(leaf1.ecx, 12), cpu::fma);
+    set(ymm && bit(leaf1.ecx, 29), cpu::f16c);
+    set(ymm && bit(leaf7.ebx, 5), cpu::avx2);
+    set(bit(leaf7.ebx, 3), cpu::bmi1);
+    set(bit(leaf7.ebx, 8), cpu::bmi2);
+    set(bit(ext1.ecx, 5), cpu::lzcnt);
+
+    set(zmm && bit(leaf7.ebx, 16), cpu::avx512f);
+    set(zmm && bit(leaf7.ebx, 17), cpu::avx512dq);
+    set(zmm && bit(leaf7.ebx, 28), cpu::avx512cd);
+    set(zmm && bit(leaf7.ebx, 30), cpu::avx512bw);
+    set(zmm && bit(leaf7.ebx, 31), cpu::avx512vl);
+    return features;
+}
+#else
+cpu_features detect() noexcept {
+    return cpu::none;
+}
+#endif
+
+std::size_t feature_count(cpu_features f) noexcept {
+    return std::bitset<32> {static_cast<std::uint32_t>(f)}.count();
+}
+
+}   // namespace
+
+cpu_features detected_cpu_features() noexcept {
+    static const auto features = detect();
+    return features;
+}
+
+variant_choice open_best_variant(const std::vector<library_variant>& variants,
+                                 flags_type flags) {
+    return open_best_variant(variants, flags, detected_cpu_features());
+}
+
+variant_choice open_best_variant(const std::vector<library_variant>& variants,
+                                 flags_type flags,
+                                 cpu_features available) {
+    std::vector<std::size_t> candidates;
+    for (std::size_t i = 0; i < variants.size(); ++i) {
+        if ((variants[i].required & ~available) == cpu::none) {
+            candidates.push_back(i);
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [&](std::size_t lhs, std::size_t rhs) {
+                         return feature_count(variants[lhs].required)
+                                > feature_count(variants[rhs].required);
+                     });
+
+    variant_choice choice {unique_shared_lib {}, variants.size()};
+    for (auto i : candidates) {
+        // A fresh library each time, so errors from earlier attempts don't
+        // stick around
+        choice.library = unique_shared_lib {variants[i].path, flags};
+        if (choice.library.last_error().empty()) {
+            choice.index = i;
+            break;
+        }
+    }
+    return choice;
+}
+
+}   // namespace reiji
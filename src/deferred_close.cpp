@@ -0,0 +1,125 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#include "deferred_close.hpp"
+
+#include <condition_variable>
+#include <cstdlib>   // std::atexit
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <reiji/unique_shared_lib.hpp>
+
+namespace reiji {
+
+namespace {
+
+// Owns the background thread that performs deferred closes. The thread is only
+// started once the first handle is queued, so programs that never use
+// close_mode::deferred don't pay for it.
+//
+// The reclaimer is never destroyed. Libraries with static storage duration
+// that were created before it still queue handles while the process exits, so
+// instead an atexit handler stops the thread once the queue is empty, and
+// anything queued after that is closed right away.
+class reclaimer final {
+public:
+    static reclaimer& instance() {
+        static reclaimer* r = [] {
+            auto created = new reclaimer;
+            std::atexit([] { instance().stop(); });
+            return created;
+        }();
+        return *r;
+    }
+
+    void push(void* handle) {
+        {
+            std::unique_lock lock {_mutex};
+            if (_stopping) {
+                lock.unlock();
+                (void)detail::close_native_handle(handle);
+                return;
+            }
+            _queue.push_back(handle);
+            if (not _thread.joinable()) {
+                _thread = std::thread {[this] { run(); }};
+            }
+        }
+        _work_available.notify_one();
+    }
+
+    void drain() {
+        std::unique_lock lock {_mutex};
+        _drained.wait(lock, [this] { return _queue.empty() && not _busy; });
+    }
+
+    // Closes whatever is still queued and joins the thread
+    void stop() {
+        {
+            std::lock_guard lock {_mutex};
+            _stopping = true;
+        }
+        _work_available.notify_one();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+private:
+    reclaimer() = default;
+
+    void run() {
+        std::vector<void*> batch;
+        std::unique_lock lock {_mutex};
+        for (;;) {
+            _work_available.wait(
+                lock, [this] { return _stopping || not _queue.empty(); });
+            if (_queue.empty()) {
+                return;   // stopping, and nothing left to close
+            }
+
+            batch.swap(_queue);
+            _busy = true;
+            lock.unlock();
+
+            for (auto handle : batch) {
+                (void)detail::close_native_handle(handle);
+            }
+            batch.clear();
+
+            lock.lock();
+            _busy = false;
+            if (_queue.empty()) {
+                _drained.notify_all();
+            }
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _work_available;
+    std::condition_variable _drained;
+    std::vector<void*> _queue;
+    bool _busy {false};
+    bool _stopping {false};
+    std::thread _thread;
+};
+
+}   // namespace
+
+namespace detail {
+
+void defer_close(void* handle) {
+    reclaimer::instance().push(handle);
+}
+
+}   // namespace detail
+
+void drain_deferred_closes() {
+    reclaimer::instance().drain();
+}
+
+}   // namespace reiji
@@ -0,0 +1,19 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <string>
+
+namespace reiji::detail {
+
+// Calls dlclose/FreeLibrary on handle, returns the error message on failure
+// and an empty string otherwise
+std::string close_native_handle(void* handle);
+
+// Queues handle to be closed by the reclaimer thread, starting it if needed
+void defer_close(void* handle);
+
+}   // namespace reiji::detail
@@ -0,0 +1,382 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+// clang-format off
+#include "elf.hpp"
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if REIJI_PLATFORM_ELF
+
+#    include <cstring>   // std::memchr, std::memcmp
+#    include <dlfcn.h>
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+
+namespace reiji::detail {
+
+namespace {
+
+// We only understand objects that could be loaded into this process, so the
+// expected class, byte order and machine are the ones we're running with
+constexpr unsigned char native_class =
+    sizeof(void*) == 8 ? ELFCLASS64 : ELFCLASS32;
+constexpr unsigned char native_data =
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ ? ELFDATA2LSB : ELFDATA2MSB;
+
+ElfW(Half) native_machine() noexcept {
+    static const ElfW(Half) machine = [] {
+        // dli_fbase is where the object containing us got mapped, which starts
+        // with its ELF header
+        ::Dl_info info {};
+        if (::dladdr(reinterpret_cast<void*>(&native_machine), &info)
+            && info.dli_fbase) {
+            return static_cast<const ElfW(Ehdr)*>(info.dli_fbase)->e_machine;
+        }
+        return static_cast<ElfW(Half)>(EM_NONE);
+    }();
+    return machine;
+}
+
+constexpr std::uint64_t align4(std::uint64_t n) noexcept {
+    return (n + 3) & ~std::uint64_t {3};
+}
+
+}   // namespace
+
+elf_file::elf_file(const std::filesystem::path& path) noexcept {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    struct ::stat st {};
+    if (::fstat(fd, &st) || not S_ISREG(st.st_mode)
+        || static_cast<std::size_t>(st.st_size) < sizeof(ElfW(Ehdr))) {
+        ::close(fd);
+        return;
+    }
+
+    _size     = static_cast<std::size_t>(st.st_size);
+    void* map = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        _size = 0;
+        return;
+    }
+    _data = static_cast<const unsigned char*>(map);
+
+    auto ehdr = reinterpret_cast<const ElfW(Ehdr)*>(_data);
+    if (std::memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0
+        || ehdr->e_ident[EI_CLASS] != native_class
+        || ehdr->e_ident[EI_DATA] != native_data || ehdr->e_type != ET_DYN
+        || ehdr->e_machine != native_machine()
+        || ehdr->e_phentsize != sizeof(ElfW(Phdr))) {
+        return;
+    }
+
+    _ehdr = ehdr;
+    _parse_dynamic();
+}
+
+elf_file::~elf_file() noexcept {
+    if (_data) {
+        ::munmap(const_cast<unsigned char*>(_data), _size);
+    }
+}
+
+template <typename T>
+const T* elf_file::_at(std::uint64_t offset,
+                       std::uint64_t count) const noexcept {
+    if (offset > _size || count > (_size - offset) / sizeof(T)) {
+        return nullptr;
+    }
+    return reinterpret_cast<const T*>(_data + offset);
+}
+
+std::string_view elf_file::_string(std::uint64_t strtab,
+                                   std::uint64_t strsz,
+                                   std::uint64_t index) const noexcept {
+    if (index >= strsz || not _at<char>(strtab, strsz)) {
+        return {};
+    }
+
+    auto begin = reinterpret_cast<const char*>(_data + strtab + index);
+    auto end =
+        static_cast<const char*>(std::memchr(begin, '\0', strsz - index));
+    return end ? std::string_view {begin, static_cast<std::size_t>(end - begin)}
+               : std::string_view {};
+}
+
+bool elf_file::_vaddr_to_offset(ElfW(Addr) vaddr,
+                                std::uint64_t& offset) const noexcept {
+    auto phdrs = _at<ElfW(Phdr)>(_ehdr->e_phoff, _ehdr->e_phnum);
+    if (not phdrs) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < _ehdr->e_phnum; ++i) {
+        auto& ph = phdrs[i];
+        if (ph.p_type == PT_LOAD && vaddr >= ph.p_vaddr
+            && vaddr - ph.p_vaddr < ph.p_filesz) {
+            offset = ph.p_offset + (vaddr - ph.p_vaddr);
+            return true;
+        }
+    }
+    return false;
+}
+
+void elf_file::_parse_dynamic() noexcept {
+    auto phdrs = _at<ElfW(Phdr)>(_ehdr->e_phoff, _ehdr->e_phnum);
+    if (not phdrs) {
+        return;
+    }
+
+    const ElfW(Dyn)* dyn  = nullptr;
+    std::size_t dyn_count = 0;
+    for (std::size_t i = 0; i < _ehdr->e_phnum; ++i) {
+        if (phdrs[i].p_type == PT_DYNAMIC) {
+            dyn_count = phdrs[i].p_filesz / sizeof(ElfW(Dyn));
+            dyn       = _at<ElfW(Dyn)>(phdrs[i].p_offset, dyn_count);
+            break;
+        }
+    }
+    if (not dyn) {
+        return;
+    }
+
+    // Strings in the dynamic section are offsets into DT_STRTAB, which we only
+    // know about once we've gone through the whole thing
+    ElfW(Addr) strtab_addr = 0;
+    std::uint64_t strsz    = 0;
+    std::uint64_t rpath = 0, runpath = 0;
+    bool has_rpath = false, has_runpath = false;
+    std::vector<std::uint64_t> needed;
+    for (std::size_t i = 0; i < dyn_count && dyn[i].d_tag != DT_NULL; ++i) {
+        switch (dyn[i].d_tag) {
+        case DT_STRTAB:
+            strtab_addr = dyn[i].d_un.d_ptr;
+            break;
+        case DT_STRSZ:
+            strsz = dyn[i].d_un.d_val;
+            break;
+        case DT_NEEDED:
+            needed.push_back(dyn[i].d_un.d_val);
+            break;
+        case DT_RPATH:
+            rpath     = dyn[i].d_un.d_val;
+            has_rpath = true;
+            break;
+        case DT_RUNPATH:
+            runpath     = dyn[i].d_un.d_val;
+            has_runpath = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    std::uint64_t strtab = 0;
+    if (not _vaddr_to_offset(strtab_addr, strtab)) {
+        return;
+    }
+
+    for (auto index : needed) {
+        auto name = _string(strtab, strsz, index);
+        if (not name.empty()) {
+            _needed.push_back(name);
+        }
+    }
+    if (has_rpath) {
+        _rpath = _string(strtab, strsz, rpath);
+    }
+    if (has_runpath) {
+        _runpath = _string(strtab, strsz, runpath);
+    }
+}
+
+std::string elf_file::build_id() const {
+    if (not valid()) {
+        return {};
+    }
+
+    auto phdrs = _at<ElfW(Phdr)>(_ehdr->e_phoff, _ehdr->e_phnum);
+    if (not phdrs) {
+        return {};
+    }
+
+    for (std::size_t i = 0; i < _ehdr->e_phnum; ++i) {
+        if (phdrs[i].p_type != PT_NOTE) {
+            continue;
+        }
+
+        std::uint64_t pos = phdrs[i].p_offset;
+        std::uint64_t end = pos + phdrs[i].p_filesz;
+        while (pos + sizeof(ElfW(Nhdr)) <= end) {
+            auto note = _at<ElfW(Nhdr)>(pos);
+            if (not note) {
+                break;
+            }
+
+            auto name = pos + sizeof(ElfW(Nhdr));
+            auto desc = name + align4(note->n_namesz);
+            auto next = desc + align4(note->n_descsz);
+            if (next > end || not _at<unsigned char>(desc, note->n_descsz)) {
+                break;
+            }
+
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4
+                && std::memcmp(_data + name, "GNU", 4) == 0) {
+                constexpr char digits[] = "0123456789abcdef";
+                std::string id;
+                id.reserve(note->n_descsz * 2);
+                for (std::uint64_t b = 0; b < note->n_descsz; ++b) {
+                    id += digits[_data[desc + b] >> 4];
+                    id += digits[_data[desc + b] & 0xf];
+                }
+                return id;
+            }
+            pos = next;
+        }
+    }
+    return {};
+}
+
+std::vector<elf_file::dynamic_symbol> elf_file::exported_symbols() const {
+    std::vector<dynamic_symbol> symbols;
+    if (not valid() || _ehdr->e_shentsize != sizeof(ElfW(Shdr))) {
+        return symbols;
+    }
+
+    auto shdrs = _at<ElfW(Shdr)>(_ehdr->e_shoff, _ehdr->e_shnum);
+    if (not shdrs) {
+        return symbols;
+    }
+
+    for (std::size_t i = 0; i < _ehdr->e_shnum; ++i) {
+        auto& sh = shdrs[i];
+        if (sh.sh_type != SHT_DYNSYM || sh.sh_entsize != sizeof(ElfW(Sym))
+            || sh.sh_link >= _ehdr->e_shnum) {
+            continue;
+        }
+
+        auto count = sh.sh_size / sizeof(ElfW(Sym));
+        auto syms  = _at<ElfW(Sym)>(sh.sh_offset, count);
+        auto& str  = shdrs[sh.sh_link];
+        if (not syms) {
+            break;
+        }
+
+        symbols.reserve(count);
+        // Index 0 is always the null symbol
+        for (std::size_t s = 1; s < count; ++s) {
+            auto& sym = syms[s];
+            auto bind = ELF64_ST_BIND(sym.st_info);
+            auto vis  = ELF64_ST_VISIBILITY(sym.st_other);
+            if (sym.st_shndx == SHN_UNDEF
+                || (bind != STB_GLOBAL && bind != STB_WEAK
+                    && bind != STB_GNU_UNIQUE)
+                || (vis != STV_DEFAULT && vis != STV_PROTECTED)) {
+                continue;
+            }
+
+            auto name = _string(str.sh_offset, str.sh_size, sym.st_name);
+            if (not name.empty()) {
+                symbols.push_back({name, sym.st_value, sym.st_size,
+                                   static_cast<unsigned char>(
+                                       ELF64_ST_TYPE(sym.st_info))});
+            }
+        }
+        break;
+    }
+    return symbols;
+}
+
+loaded_image::loaded_image(void* handle) noexcept {
+    ::link_map* map = nullptr;
+    if (not handle || ::dlinfo(handle, RTLD_DI_LINKMAP, &map) || not map
+        || not map->l_ld) {
+        return;
+    }
+    base = map->l_addr;
+
+    // glibc relocates the pointers in the dynamic section when loading an
+    // object, other loaders (e.g. musl's) leave them as they are in the file
+    auto relocate = [this](ElfW(Addr) ptr) {
+        return ptr < base ? ptr + base : ptr;
+    };
+
+    for (auto dyn = map->l_ld; dyn->d_tag != DT_NULL; ++dyn) {
+        switch (dyn->d_tag) {
+        case DT_SYMTAB:
+            symtab = reinterpret_cast<const ElfW(Sym)*>(
+                relocate(dyn->d_un.d_ptr));
+            break;
+        case DT_STRTAB:
+            strtab = reinterpret_cast<const char*>(relocate(dyn->d_un.d_ptr));
+            break;
+        case DT_STRSZ:
+            strsz = dyn->d_un.d_val;
+            break;
+        case DT_HASH:
+            sysv_hash = reinterpret_cast<const ElfW(Word)*>(
+                relocate(dyn->d_un.d_ptr));
+            break;
+        case DT_GNU_HASH:
+            gnu_hash = reinterpret_cast<const std::uint32_t*>(
+                relocate(dyn->d_un.d_ptr));
+            break;
+        case DT_VERSYM:
+            versym = reinterpret_cast<const ElfW(Half)*>(
+                relocate(dyn->d_un.d_ptr));
+            break;
+        default:
+            break;
+        }
+    }
+
+    // The dynamic section doesn't record how many symbols there are, but the
+    // hash tables do. DT_HASH has it directly, for DT_GNU_HASH we need to find
+    // the end of the last chain.
+    if (sysv_hash) {
+        symbol_count = sysv_hash[1];
+    } else if (gnu_hash) {
+        auto nbuckets   = gnu_hash[0];
+        auto symoffset  = gnu_hash[1];
+        auto bloom_size = gnu_hash[2];
+        auto buckets    = reinterpret_cast<const std::uint32_t*>(
+            reinterpret_cast<const ElfW(Addr)*>(gnu_hash + 4) + bloom_size);
+        auto chains = buckets + nbuckets;
+
+        std::uint32_t last = 0;
+        for (std::uint32_t b = 0; b < nbuckets; ++b) {
+            last = buckets[b] > last ? buckets[b] : last;
+        }
+        if (last < symoffset) {
+            symbol_count = symoffset;
+        } else {
+            while (not(chains[last - symoffset] & 1)) {
+                ++last;
+            }
+            symbol_count = last + 1;
+        }
+    }
+}
+
+bool loaded_image::is_exported(std::size_t index) const noexcept {
+    auto& sym = symtab[index];
+    auto bind = ELF64_ST_BIND(sym.st_info);
+    auto vis  = ELF64_ST_VISIBILITY(sym.st_other);
+    return sym.st_shndx != SHN_UNDEF && sym.st_name < strsz
+           && (bind == STB_GLOBAL || bind == STB_WEAK
+               || bind == STB_GNU_UNIQUE)
+           && (vis == STV_DEFAULT || vis == STV_PROTECTED);
+}
+
+}   // namespace reiji::detail
+
+#endif
@@ -0,0 +1,104 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <reiji/detail/push_platform_detection_macros.hpp>
+
+#if REIJI_PLATFORM_ELF
+
+#    include <cstddef>   // std::size_t
+#    include <cstdint>   // std::uint64_t
+#    include <filesystem>
+#    include <link.h>   // ElfW
+#    include <string>
+#    include <string_view>
+#    include <vector>
+
+namespace reiji::detail {
+
+// A read-only, memory mapped view of an ELF shared object on disk. Nothing
+// from the file gets loaded or run, so it's fine to point this at files we
+// don't trust to be plugins (or even shared libraries) yet.
+class elf_file final {
+public:
+    struct dynamic_symbol {
+        std::string_view name;
+        std::uint64_t value;
+        std::uint64_t size;
+        unsigned char type;
+    };
+
+    explicit elf_file(const std::filesystem::path& path) noexcept;
+    ~elf_file() noexcept;
+
+    elf_file(const elf_file&) = delete;
+    elf_file& operator=(const elf_file&) = delete;
+
+    // True if the file got mapped and is an ELF object with the same class,
+    // byte order and machine as the running process
+    bool valid() const noexcept { return _ehdr; }
+
+    // All the string_views handed out below point into the mapping, so they
+    // are only usable for as long as the elf_file is alive
+
+    const std::vector<std::string_view>& needed() const noexcept {
+        return _needed;
+    }
+    std::string_view rpath() const noexcept { return _rpath; }
+    std::string_view runpath() const noexcept { return _runpath; }
+
+    // Hex encoded NT_GNU_BUILD_ID note, or an empty string if there's none
+    std::string build_id() const;
+
+    // Symbols from .dynsym that are defined in this object and visible to
+    // dlsym
+    std::vector<dynamic_symbol> exported_symbols() const;
+
+private:
+    template <typename T>
+    const T* _at(std::uint64_t offset, std::uint64_t count = 1) const noexcept;
+    std::string_view _string(std::uint64_t strtab,
+                             std::uint64_t strsz,
+                             std::uint64_t index) const noexcept;
+    bool _vaddr_to_offset(ElfW(Addr) vaddr,
+                          std::uint64_t& offset) const noexcept;
+    void _parse_dynamic() noexcept;
+
+    const unsigned char* _data {nullptr};
+    std::size_t _size {0};
+    const ElfW(Ehdr)* _ehdr {nullptr};
+    std::vector<std::string_view> _needed;
+    std::string_view _rpath;
+    std::string_view _runpath;
+};
+
+// The dynamic symbol table of an object that's already loaded into this
+// process, read straight from memory. Everything points into the image, so it
+// is only usable for as long as the library stays loaded.
+struct loaded_image final {
+    // handle is what dlopen returned
+    explicit loaded_image(void* handle) noexcept;
+
+    bool valid() const noexcept { return symtab && strtab && symbol_count; }
+
+    // Whether symtab[index] is something dlsym could hand out
+    bool is_exported(std::size_t index) const noexcept;
+
+    ElfW(Addr) base {0};
+    const ElfW(Sym)* symtab {nullptr};
+    const char* strtab {nullptr};
+    std::size_t strsz {0};
+    std::size_t symbol_count {0};
+    const std::uint32_t* gnu_hash {nullptr};
+    const ElfW(Word)* sysv_hash {nullptr};
+    const ElfW(Half)* versym {nullptr};
+};
+
+}   // namespace reiji::detail
+
+#endif
+
+#include <reiji/detail/pop_platform_detection_macros.hpp>
@@ -0,0 +1,35 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#include <reiji/fast_exit.hpp>
+
+#include <atomic>
+
+namespace reiji {
+
+namespace {
+
+// Only ever read from close(), nothing else is ordered by it
+std::atomic<bool> fast_exit {false};
+
+}   // namespace
+
+void set_fast_exit(bool enabled) noexcept {
+    fast_exit.store(enabled, std::memory_order_relaxed);
+}
+
+bool fast_exit_enabled() noexcept {
+    return fast_exit.load(std::memory_order_relaxed);
+}
+
+void close_in_order(const std::vector<unique_shared_lib*>& libraries) {
+    for (auto lib : libraries) {
+        if (lib) {
+            lib->_unload(close_mode::immediate);
+        }
+    }
+}
+
+}   // namespace reiji
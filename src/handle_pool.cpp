@@ -0,0 +1,174 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#include <reiji/handle_pool.hpp>
+
+#include "deferred_close.hpp"
+#include "handle_pool_state.hpp"
+#include "open_handles.hpp"
+
+#include <utility>   // std::move
+
+namespace reiji {
+
+namespace detail {
+
+handle_pool_state::~handle_pool_state() noexcept {
+    // Pooled libraries keep the state alive, so whatever is left is idle
+    evicted_list evicted;
+    for (auto handle : _idle) {
+        evicted.emplace_back(handle, _entries[handle].mode);
+    }
+    (void)_close(evicted);
+}
+
+void* handle_pool_state::acquire(const key& name) {
+    std::lock_guard lock {_mutex};
+    auto it = _names.find(name);
+    if (it == _names.end()) {
+        return nullptr;
+    }
+
+    auto& e = _entries[it->second];
+    if (e.users++ == 0) {
+        _idle.erase(e.idle_position);
+    }
+    return it->second;
+}
+
+void handle_pool_state::adopt(const key& name, void* handle) {
+    bool already_pooled = false;
+    {
+        std::lock_guard lock {_mutex};
+        auto [it, inserted] = _entries.try_emplace(handle);
+        auto& e             = it->second;
+        if (not inserted && e.users == 0) {
+            _idle.erase(e.idle_position);
+        }
+        ++e.users;
+        if (_names.emplace(name, handle).second) {
+            e.names.push_back(name);
+        }
+        already_pooled = not inserted;
+    }
+
+    // Already pooled under another name (or another thread got here first),
+    // the pool's own reference is enough
+    if (already_pooled) {
+        (void)close_native_handle(handle);
+    }
+}
+
+std::string handle_pool_state::release(void* handle, close_mode mode) {
+    evicted_list evicted;
+    {
+        std::lock_guard lock {_mutex};
+        auto it = _entries.find(handle);
+        if (it != _entries.end()) {
+            auto& e = it->second;
+            if (--e.users == 0) {
+                _idle.push_front(handle);
+                e.idle_position = _idle.begin();
+                e.mode          = mode;
+            }
+            evicted = _evict();
+        } else {
+            evicted.emplace_back(handle, mode);
+        }
+    }
+    return _close(evicted);
+}
+
+void handle_pool_state::set_capacity(std::size_t capacity) {
+    evicted_list evicted;
+    {
+        std::lock_guard lock {_mutex};
+        _capacity = capacity;
+        evicted   = _evict();
+    }
+    (void)_close(evicted);
+}
+
+std::size_t handle_pool_state::capacity() const {
+    std::lock_guard lock {_mutex};
+    return _capacity;
+}
+
+std::size_t handle_pool_state::idle() const {
+    std::lock_guard lock {_mutex};
+    return _idle.size();
+}
+
+handle_pool_state::evicted_list handle_pool_state::_evict() {
+    evicted_list evicted;
+    while (_idle.size() > _capacity) {
+        auto handle = _idle.back();
+        _idle.pop_back();
+
+        auto it = _entries.find(handle);
+        for (auto& name : it->second.names) {
+            _names.erase(name);
+        }
+        evicted.emplace_back(handle, it->second.mode);
+        _entries.erase(it);
+    }
+    return evicted;
+}
+
+std::string handle_pool_state::_close(const evicted_list& evicted) {
+    std::string error;
+    for (auto [handle, mode] : evicted) {
+        if (mode == close_mode::deferred) {
+            defer_close(handle);
+        } else if (auto err = close_native_handle(handle); error.empty()) {
+            error = std::move(err);
+        }
+    }
+    return error;
+}
+
+}   // namespace detail
+
+handle_pool::handle_pool(std::size_t capacity)
+    : _state {std::make_shared<detail::handle_pool_state>(capacity)} {}
+
+handle_pool::~handle_pool() noexcept {
+    if (_state) {
+        _state->set_capacity(0);
+    }
+}
+
+unique_shared_lib handle_pool::open(const fs::path& path, flags_type flags) {
+    auto name = detail::handle_pool_state::key {
+        path.native(), static_cast<detail::raw_flags_type>(flags)};
+
+    unique_shared_lib lib;
+    if (auto handle = _state->acquire(name)) {
+        lib._handle = handle;
+        detail::register_open_handle(handle);
+    } else {
+        lib.open(path, flags);
+        if (not lib._handle) {
+            return lib;
+        }
+        _state->adopt(name, lib._handle);
+    }
+    lib._pool = _state;
+    return lib;
+}
+
+void handle_pool::set_capacity(std::size_t capacity) {
+    _state->set_capacity(capacity);
+}
+
+std::size_t handle_pool::capacity() const {
+    return _state->capacity();
+}
+
+std::size_t handle_pool::idle() const {
+    return _state->idle();
+}
+
+}   // namespace reiji
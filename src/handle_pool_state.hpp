@@ -0,0 +1,80 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>   // std::size_t
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>   // std::pair
+#include <vector>
+
+#include <reiji/flags.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+namespace reiji::detail {
+
+// The part of a handle_pool that pooled unique_shared_libs keep alive, so that
+// they can still return their handles after the pool itself is gone.
+//
+// The pool owns exactly one platform reference to every library in it, which
+// it shares between everyone who opened the library through the pool. Once
+// nobody is using a library anymore, it goes on the idle list (most recently
+// released first), and is only really closed when it falls off the end of it.
+class handle_pool_state final {
+public:
+    using key = std::pair<std::filesystem::path::string_type, raw_flags_type>;
+
+    explicit handle_pool_state(std::size_t capacity) noexcept
+        : _capacity {capacity} {}
+    ~handle_pool_state() noexcept;
+
+    // Returns the pooled handle for name, or nullptr if it isn't pooled
+    void* acquire(const key& name);
+    // Takes over handle, which a user just got from the platform for name
+    void adopt(const key& name, void* handle);
+    // Returns the error from closing handle if that happened right away
+    std::string release(void* handle, close_mode mode);
+
+    void set_capacity(std::size_t capacity);
+    std::size_t capacity() const;
+    std::size_t idle() const;
+
+private:
+    struct key_hash {
+        std::size_t operator()(const key& k) const noexcept {
+            auto h = std::hash<key::first_type> {}(k.first);
+            return h ^ (std::hash<key::second_type> {}(k.second) << 1);
+        }
+    };
+
+    struct entry {
+        std::size_t users {0};
+        // Every name the library was opened by
+        std::vector<key> names;
+        std::list<void*>::iterator idle_position;
+        // How the user who released the library last wanted it closed
+        close_mode mode {close_mode::immediate};
+    };
+
+    using evicted_list = std::vector<std::pair<void*, close_mode>>;
+
+    // Unlinks idle handles past the capacity, the caller closes them once the
+    // lock is released
+    evicted_list _evict();
+    // Returns the first error from the handles closed right away
+    static std::string _close(const evicted_list& evicted);
+
+    mutable std::mutex _mutex;
+    std::size_t _capacity;
+    std::unordered_map<key, void*, key_hash> _names;
+    std::unordered_map<void*, entry> _entries;
+    std::list<void*> _idle;
+};
+
+}   // namespace reiji::detail
@@ -0,0 +1,186 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+// clang-format off
+#include <reiji/library_resolver.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if defined(__linux__)
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+#include <array>
+#include <system_error>
+#include <utility>   // std::move
+
+namespace reiji {
+
+namespace {
+
+#if defined(__APPLE__)
+constexpr std::string_view prefix = "lib";
+constexpr std::string_view suffix = ".dylib";
+#elif REIJI_PLATFORM_POSIX
+constexpr std::string_view prefix = "lib";
+constexpr std::string_view suffix = ".so";
+#elif REIJI_PLATFORM_WINDOWS
+constexpr std::string_view prefix = "";
+constexpr std::string_view suffix = ".dll";
+#endif
+
+std::array<std::string, 3> candidate_names(std::string_view name) {
+    std::string prefixed {prefix};
+    prefixed += name;
+    prefixed += suffix;
+
+    std::string suffixed {name};
+    suffixed += suffix;
+
+    return {std::string {name}, std::move(prefixed), std::move(suffixed)};
+}
+
+}   // namespace
+
+library_resolver::library_resolver(std::vector<fs::path> search_dirs,
+                                   resolver_invalidation invalidation)
+    : _search_dirs {std::move(search_dirs)}, _dirs(_search_dirs.size()) {
+#if defined(__linux__)
+    if (invalidation != resolver_invalidation::watch) {
+        return;
+    }
+
+    _inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotify_fd < 0) {
+        return;
+    }
+
+    // Directories that don't exist (yet) can't be watched, those need to be
+    // invalidated manually if they ever appear
+    for (std::size_t i = 0; i < _search_dirs.size(); ++i) {
+        _dirs[i].watch = ::inotify_add_watch(
+            _inotify_fd, _search_dirs[i].c_str(),
+            IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+    }
+#else
+    (void)invalidation;
+#endif
+}
+
+library_resolver::~library_resolver() noexcept {
+#if defined(__linux__)
+    if (_inotify_fd >= 0) {
+        ::close(_inotify_fd);
+    }
+#endif
+}
+
+std::optional<fs::path> library_resolver::resolve(std::string_view name) {
+    if (name.empty()) {
+        return std::nullopt;
+    }
+
+    fs::path as_path {name};
+    if (as_path.has_parent_path()) {
+        return as_path;
+    }
+
+    auto candidates = candidate_names(name);
+
+    std::lock_guard lock {_mutex};
+    _read_watch_events();
+    for (std::size_t i = 0; i < _dirs.size(); ++i) {
+        if (not _dirs[i].listed) {
+            _list(i);
+        }
+
+        for (auto& candidate : candidates) {
+            if (_dirs[i].entries.count(candidate)) {
+                return _search_dirs[i] / candidate;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+unique_shared_lib library_resolver::open(std::string_view name,
+                                         flags_type flags) {
+    if (auto path = resolve(name)) {
+        return unique_shared_lib {*path, flags};
+    }
+    return unique_shared_lib {std::string {name}, flags};
+}
+
+void library_resolver::invalidate() {
+    std::lock_guard lock {_mutex};
+    for (auto& dir : _dirs) {
+        dir.listed = false;
+    }
+}
+
+void library_resolver::invalidate(const fs::path& dir) {
+    std::lock_guard lock {_mutex};
+    for (std::size_t i = 0; i < _dirs.size(); ++i) {
+        if (_search_dirs[i] == dir) {
+            _dirs[i].listed = false;
+        }
+    }
+}
+
+void library_resolver::_read_watch_events() {
+#if defined(__linux__)
+    if (_inotify_fd < 0) {
+        return;
+    }
+
+    // The fd is non blocking, so when nothing changed this is a single read
+    // that fails with EAGAIN
+    alignas(::inotify_event) char buf[4096];
+    for (;;) {
+        auto len = ::read(_inotify_fd, buf, sizeof(buf));
+        if (len <= 0) {
+            return;
+        }
+
+        for (decltype(len) pos = 0; pos < len;) {
+            auto event = reinterpret_cast<const ::inotify_event*>(buf + pos);
+            pos += sizeof(::inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (auto& dir : _dirs) {
+                    dir.listed = false;
+                }
+                continue;
+            }
+            for (auto& dir : _dirs) {
+                if (dir.watch == event->wd) {
+                    dir.listed = false;
+                }
+            }
+        }
+    }
+#endif
+}
+
+void library_resolver::_list(std::size_t index) {
+    auto& dir = _dirs[index];
+    dir.entries.clear();
+    dir.listed = true;
+
+    // Only files can be libraries. The entry's type usually comes with the
+    // listing itself, so only symlinks cost a stat to see what they point at.
+    std::error_code ec;
+    for (fs::directory_iterator it {_search_dirs[index], ec}, end;
+         not ec && it != end; it.increment(ec)) {
+        std::error_code type_ec;
+        if (it->is_regular_file(type_ec)) {
+            dir.entries.insert(it->path().filename().string());
+        }
+    }
+}
+
+}   // namespace reiji
@@ -0,0 +1,127 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+// clang-format off
+#include <reiji/library_set.hpp>
+#include "elf.hpp"
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#include <algorithm>   // std::upper_bound, std::find_if
+#include <utility>     // std::move
+
+namespace reiji {
+
+namespace {
+
+#if REIJI_PLATFORM_ELF
+// The filters are "blocked": all the bits for a name live in the same 64 bit
+// word, so a query costs one load however big the filter is
+struct bloom_bits {
+    std::size_t word;
+    std::uint64_t mask;
+};
+
+bloom_bits bloom_bits_for(std::uint32_t hash, std::size_t words) noexcept {
+    auto x = hash * std::uint64_t {0x9e3779b97f4a7c15};
+    return {static_cast<std::size_t>(x & (words - 1)),
+            (std::uint64_t {1} << ((x >> 40) & 63))
+                | (std::uint64_t {1} << ((x >> 46) & 63))
+                | (std::uint64_t {1} << ((x >> 52) & 63))};
+}
+#endif
+
+}   // namespace
+
+unique_shared_lib& library_set::add(unique_shared_lib lib, int precedence) {
+    auto pos = std::upper_bound(
+        _members.begin(), _members.end(), precedence,
+        [](int p, const member& m) { return p > m.precedence; });
+    // The filter is built by the first lookup
+    auto it = _members.insert(
+        pos, member {std::make_unique<unique_shared_lib>(std::move(lib)),
+                     precedence, nullptr, {}});
+    return *it->lib;
+}
+
+bool library_set::remove(const unique_shared_lib& lib) noexcept {
+    auto it = std::find_if(
+        _members.begin(), _members.end(),
+        [&](const member& m) { return m.lib.get() == &lib; });
+    if (it == _members.end()) {
+        return false;
+    }
+    _members.erase(it);
+    return true;
+}
+
+unique_shared_lib* library_set::provider(const hashed_name& name) {
+    for (auto& m : _members) {
+        if (_lookup(m, name)) {
+            return m.lib.get();
+        }
+    }
+    return nullptr;
+}
+
+void library_set::_index(member& m) {
+    m.bloom.clear();
+
+#if REIJI_PLATFORM_ELF
+    auto image = m.lib->_loaded_image();
+    m.image    = m.lib->_image;
+    if (not image) {
+        return;
+    }
+
+    std::size_t exported = 0;
+    for (std::size_t i = 1; i < image->symbol_count; ++i) {
+        exported += image->is_exported(i);
+    }
+
+    // ~16 bits per name keeps false positives around 1%
+    std::size_t words = 1;
+    while (words * 4 < exported) {
+        words *= 2;
+    }
+    m.bloom.assign(words, 0);
+
+    for (std::size_t i = 1; i < image->symbol_count; ++i) {
+        if (image->is_exported(i)) {
+            auto name = image->strtab + image->symtab[i].st_name;
+            auto bits = bloom_bits_for(
+                detail::gnu_hash(name, std::strlen(name)), words);
+            m.bloom[bits.word] |= bits.mask;
+        }
+    }
+#else
+    (void)m;
+#endif
+}
+
+void* library_set::_lookup(member& m, const hashed_name& name) {
+    if (m.lib->_static) {
+        // Already as cheap as the filter would be
+        return m.lib->_get_local_symbol(name);
+    }
+    if (not m.lib->_handle) {
+        return nullptr;
+    }
+
+#if REIJI_PLATFORM_ELF
+    if (not m.image || m.image != m.lib->_image) {
+        _index(m);
+    }
+    if (not m.bloom.empty()) {
+        auto bits = bloom_bits_for(name.hash, m.bloom.size());
+        if ((m.bloom[bits.word] & bits.mask) != bits.mask) {
+            return nullptr;
+        }
+    }
+#endif
+    return m.lib->_get_local_symbol(name);
+}
+
+}   // namespace reiji
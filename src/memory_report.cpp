@@ -0,0 +1,208 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#include <reiji/memory_report.hpp>
+#include <reiji/unique_shared_lib.hpp>
+
+#include "open_handles.hpp"
+
+#if defined(__linux__)
+#    include <cstdio>    // std::FILE, std::fopen
+#    include <cstdlib>   // std::strtoull, std::free
+#    include <cstring>   // std::strchr, std::strncmp
+#    include <dlfcn.h>
+#    include <link.h>   // dl_iterate_phdr
+#    include <unistd.h>
+#endif
+
+#include <algorithm>   // std::sort, std::upper_bound, std::binary_search
+#include <iterator>    // std::prev
+
+namespace reiji {
+
+namespace {
+
+#if defined(__linux__)
+// Appends the PT_LOAD segments of every loaded object whose dynamic section is
+// in dynamics, which must be sorted
+void add_segments(const std::vector<const void*>& dynamics,
+                  std::vector<segment_usage>& segments) {
+    struct context {
+        const std::vector<const void*>& dynamics;
+        std::vector<segment_usage>& segments;
+        std::uintptr_t page_size;
+    } ctx {dynamics, segments,
+           static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE))};
+
+    ::dl_iterate_phdr(
+        [](::dl_phdr_info* info, std::size_t, void* data) {
+            auto& ctx    = *static_cast<context*>(data);
+            auto phdrs   = info->dlpi_phdr;
+            auto matches = false;
+            for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i) {
+                if (phdrs[i].p_type == PT_DYNAMIC) {
+                    auto dynamic = reinterpret_cast<const void*>(
+                        info->dlpi_addr + phdrs[i].p_vaddr);
+                    matches = std::binary_search(ctx.dynamics.begin(),
+                                                 ctx.dynamics.end(), dynamic);
+                    break;
+                }
+            }
+            if (not matches) {
+                return 0;
+            }
+
+            auto mask = ~(ctx.page_size - 1);
+            for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i) {
+                auto& phdr = phdrs[i];
+                if (phdr.p_type != PT_LOAD || phdr.p_memsz == 0) {
+                    continue;
+                }
+                auto start = info->dlpi_addr + phdr.p_vaddr;
+                auto end   = start + phdr.p_memsz;
+
+                segment_usage segment;
+                segment.start      = start & mask;
+                segment.end        = (end + ctx.page_size - 1) & mask;
+                segment.readable   = phdr.p_flags & PF_R;
+                segment.writable   = phdr.p_flags & PF_W;
+                segment.executable = phdr.p_flags & PF_X;
+                ctx.segments.push_back(segment);
+            }
+            return 0;
+        },
+        &ctx);
+}
+
+const void* dynamic_section(void* handle) {
+    ::link_map* map = nullptr;
+    if (::dlinfo(handle, RTLD_DI_LINKMAP, &map) || not map) {
+        return nullptr;
+    }
+    return map->l_ld;
+}
+
+// Adds every mapping in /proc/self/smaps that starts inside one of segments
+// to that segment's usage. segments must be sorted and not overlap.
+void read_smaps(std::vector<segment_usage>& segments) {
+    struct field {
+        const char* name;
+        std::size_t length;
+        std::size_t memory_usage::*member;
+    };
+    static constexpr field fields[] = {
+        {"Size", 4, &memory_usage::size},
+        {"Rss", 3, &memory_usage::rss},
+        {"Pss", 3, &memory_usage::pss},
+        {"Shared_Clean", 12, &memory_usage::shared_clean},
+        {"Shared_Dirty", 12, &memory_usage::shared_dirty},
+        {"Private_Clean", 13, &memory_usage::private_clean},
+        {"Private_Dirty", 13, &memory_usage::private_dirty},
+        {"Swap", 4, &memory_usage::swap},
+    };
+
+    auto file = std::fopen("/proc/self/smaps", "re");
+    if (not file) {
+        return;
+    }
+
+    char* line           = nullptr;
+    std::size_t capacity = 0;
+    memory_usage* usage  = nullptr;
+    while (::getline(&line, &capacity, file) != -1) {
+        // Mappings start with "start-end perms offset major:minor ...", and
+        // their fields with "Name:"
+        auto colon = std::strchr(line, ':');
+        auto dash  = std::strchr(line, '-');
+        if (dash && (not colon || dash < colon)) {
+            auto start = static_cast<std::uintptr_t>(
+                std::strtoull(line, nullptr, 16));
+            auto it = std::upper_bound(
+                segments.begin(), segments.end(), start,
+                [](std::uintptr_t addr, const segment_usage& segment) {
+                    return addr < segment.start;
+                });
+            usage = nullptr;
+            if (it != segments.begin() && start < std::prev(it)->end) {
+                usage = &std::prev(it)->usage;
+            }
+            continue;
+        }
+
+        if (not usage || not colon) {
+            continue;
+        }
+        auto length = static_cast<std::size_t>(colon - line);
+        for (auto& f : fields) {
+            if (length == f.length && std::strncmp(line, f.name, length) == 0) {
+                // Always in kB
+                auto kb = std::strtoull(colon + 1, nullptr, 10);
+                usage->*f.member += static_cast<std::size_t>(kb) * 1024;
+                break;
+            }
+        }
+    }
+
+    std::free(line);
+    std::fclose(file);
+}
+
+memory_usage sum(const std::vector<segment_usage>& segments) {
+    memory_usage total;
+    for (auto& segment : segments) {
+        total += segment.usage;
+    }
+    return total;
+}
+#endif
+
+}   // namespace
+
+memory_report unique_shared_lib::memory_footprint() const {
+    memory_report report;
+#if defined(__linux__)
+    auto dynamic = _handle ? dynamic_section(_handle) : nullptr;
+    if (not dynamic) {
+        return report;
+    }
+
+    add_segments({dynamic}, report.segments);
+    std::sort(report.segments.begin(), report.segments.end(),
+              [](const segment_usage& lhs, const segment_usage& rhs) {
+                  return lhs.start < rhs.start;
+              });
+    read_smaps(report.segments);
+    report.total = sum(report.segments);
+#endif
+    return report;
+}
+
+memory_usage open_libraries_memory_usage() {
+#if defined(__linux__)
+    std::vector<const void*> dynamics;
+    detail::for_each_open_handle([&](void* handle) {
+        if (auto dynamic = dynamic_section(handle)) {
+            dynamics.push_back(dynamic);
+        }
+    });
+    if (dynamics.empty()) {
+        return {};
+    }
+    std::sort(dynamics.begin(), dynamics.end());
+
+    std::vector<segment_usage> segments;
+    add_segments(dynamics, segments);
+    std::sort(segments.begin(), segments.end(),
+              [](const segment_usage& lhs, const segment_usage& rhs) {
+                  return lhs.start < rhs.start;
+              });
+    read_smaps(segments);
+    return sum(segments);
+#else
+    return {};
+#endif
+}
+
+}   // namespace reiji
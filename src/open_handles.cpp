@@ -0,0 +1,98 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#include "open_handles.hpp"
+
+#include <condition_variable>
+#include <cstddef>   // std::size_t
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace reiji::detail {
+
+namespace {
+
+struct registry {
+    std::mutex mutex;
+    // The same library may be open through several unique_shared_libs
+    std::unordered_map<void*, std::size_t> handles;
+    // Handles for_each_open_handle is calling back with right now, once per
+    // call in progress
+    std::unordered_multiset<void*> pinned;
+    std::condition_variable unpinned;
+};
+
+// Pins a handle for as long as a callback is looking at it
+class pin final {
+public:
+    pin(registry& r, void* handle) noexcept : _r {r}, _handle {handle} {}
+    ~pin() {
+        {
+            std::lock_guard lock {_r.mutex};
+            _r.pinned.erase(_r.pinned.find(_handle));
+        }
+        _r.unpinned.notify_all();
+    }
+
+    pin(const pin&) = delete;
+    pin& operator=(const pin&) = delete;
+
+private:
+    registry& _r;
+    void* _handle;
+};
+
+registry& get_registry() {
+    static registry r;
+    return r;
+}
+
+}   // namespace
+
+void register_open_handle(void* handle) {
+    auto& r = get_registry();
+    std::lock_guard lock {r.mutex};
+    ++r.handles[handle];
+}
+
+void unregister_open_handle(void* handle) {
+    auto& r = get_registry();
+    std::unique_lock lock {r.mutex};
+    auto it = r.handles.find(handle);
+    if (it != r.handles.end() && --it->second == 0) {
+        r.handles.erase(it);
+        // Our caller is about to close the handle, which mustn't happen while
+        // a callback still looks at it
+        r.unpinned.wait(lock, [&] { return r.pinned.count(handle) == 0; });
+    }
+}
+
+void for_each_open_handle(const std::function<void(void*)>& f) {
+    auto& r = get_registry();
+    std::vector<void*> handles;
+    {
+        std::lock_guard lock {r.mutex};
+        handles.reserve(r.handles.size());
+        for (auto& [handle, count] : r.handles) {
+            handles.push_back(handle);
+        }
+    }
+
+    for (auto handle : handles) {
+        {
+            std::lock_guard lock {r.mutex};
+            if (r.handles.find(handle) == r.handles.end()) {
+                continue;
+            }
+            r.pinned.insert(handle);
+        }
+        pin pinned {r, handle};
+        f(handle);
+    }
+}
+
+}   // namespace reiji::detail
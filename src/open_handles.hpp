@@ -0,0 +1,24 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <functional>
+
+namespace reiji::detail {
+
+// Keeps count of the native handles owned by unique_shared_libs, for reports
+// that cover every library reiji has open
+
+void register_open_handle(void* handle);
+void unregister_open_handle(void* handle);
+
+// Calls f once for every handle registered when it starts, except those
+// closed meanwhile. The registry isn't locked while f runs, instead closing
+// the handle f was just given waits for f to return. So f may open and close
+// libraries, just not the one it was called with.
+void for_each_open_handle(const std::function<void(void*)>& f);
+
+}   // namespace reiji::detail
@@ -0,0 +1,37 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>   // std::min, std::max
+#include <cstddef>     // std::size_t
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace reiji::detail {
+
+// Calls f(i) for every i in [0, count) from up to one thread per core. Each
+// worker takes every n-th index, so f must be fine with running concurrently
+// for different indices.
+template <typename F>
+void parallel_for(std::size_t count, const F& f) {
+    auto worker_count = std::min<std::size_t>(
+        std::max(1u, std::thread::hardware_concurrency()), count);
+
+    std::vector<std::future<void>> workers;
+    for (std::size_t w = 0; w < worker_count; ++w) {
+        workers.push_back(std::async(std::launch::async, [&, w] {
+            for (auto i = w; i < count; i += worker_count) {
+                f(i);
+            }
+        }));
+    }
+    for (auto& worker : workers) {
+        worker.get();
+    }
+}
+
+}   // namespace reiji::detail
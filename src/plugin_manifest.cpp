@@ -0,0 +1,368 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+// clang-format off
+#include <reiji/plugin_manifest.hpp>
+#include "elf.hpp"
+#include "parallel_for.hpp"
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#include <algorithm>   // std::sort, std::lower_bound, std::all_of
+#include <cstring>     // std::memcpy
+#include <fstream>
+#include <system_error>
+#include <utility>   // std::move
+
+namespace reiji {
+
+namespace {
+
+// Bumped whenever the layout below changes
+constexpr char magic[8] = {'R', 'E', 'I', 'J', 'I', 'P', 'M', '1'};
+
+// Everything is written in the machine's own byte order, as: magic, entry
+// count, then for every entry its path, size, mtime, is_library, build_id,
+// export_names, export_offsets and needed. Strings are a length followed by
+// their bytes, lists a count followed by their elements.
+class writer {
+public:
+    void u64(std::uint64_t value) {
+        auto pos = _out.size();
+        _out.resize(pos + sizeof(value));
+        std::memcpy(_out.data() + pos, &value, sizeof(value));
+    }
+    void string(const std::string& s) {
+        u64(s.size());
+        _out += s;
+    }
+    void u32s(const std::vector<std::uint32_t>& list) {
+        u64(list.size());
+        if (not list.empty()) {
+            auto pos = _out.size();
+            _out.resize(pos + list.size() * sizeof(std::uint32_t));
+            std::memcpy(_out.data() + pos, list.data(),
+                        list.size() * sizeof(std::uint32_t));
+        }
+    }
+    void strings(const std::vector<std::string>& list) {
+        u64(list.size());
+        for (auto& s : list) {
+            string(s);
+        }
+    }
+
+    std::string& bytes() noexcept { return _out; }
+
+private:
+    std::string _out;
+};
+
+class reader {
+public:
+    explicit reader(const std::string& in) noexcept : _in {in} {}
+
+    bool ok() const noexcept { return _ok; }
+
+    std::uint64_t u64() {
+        std::uint64_t value = 0;
+        if (not _take(sizeof(value))) {
+            return 0;
+        }
+        std::memcpy(&value, _in.data() + _pos - sizeof(value), sizeof(value));
+        return value;
+    }
+    std::string string() {
+        auto length = u64();
+        if (not _take(length)) {
+            return {};
+        }
+        return _in.substr(_pos - length, length);
+    }
+    std::vector<std::uint32_t> u32s() {
+        auto count = u64();
+        auto bytes = count * sizeof(std::uint32_t);
+        std::vector<std::uint32_t> list;
+        // The count is checked before it's multiplied or allocated for
+        if (count > (_in.size() - _pos) / sizeof(std::uint32_t)
+            || not _take(bytes)) {
+            _ok = false;
+            return list;
+        }
+        if (count > 0) {
+            list.resize(count);
+            std::memcpy(list.data(), _in.data() + _pos - bytes, bytes);
+        }
+        return list;
+    }
+    std::vector<std::string> strings() {
+        auto count = u64();
+        std::vector<std::string> list;
+        for (; _ok && count > 0; --count) {
+            // Every string takes at least 8 bytes, checking for those keeps a
+            // corrupt count from making us allocate the world
+            _ok = _in.size() - _pos >= 8;
+            if (_ok) {
+                list.push_back(string());
+            }
+        }
+        return list;
+    }
+
+private:
+    bool _take(std::uint64_t count) noexcept {
+        _ok = _ok && count <= _in.size() - _pos;
+        if (_ok) {
+            _pos += count;
+        }
+        return _ok;
+    }
+
+    const std::string& _in;
+    std::size_t _pos {sizeof(magic)};
+    bool _ok {true};
+};
+
+void parse(manifest_entry& entry) {
+    entry.build_id.clear();
+    entry.export_names.clear();
+    entry.export_offsets.clear();
+    entry.needed.clear();
+
+#if REIJI_PLATFORM_ELF
+    detail::elf_file elf {entry.path};
+    entry.is_library = elf.valid();
+    if (not entry.is_library) {
+        return;
+    }
+
+    entry.build_id = elf.build_id();
+
+    std::vector<std::string_view> names;
+    for (auto& sym : elf.exported_symbols()) {
+        names.push_back(sym.name);
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    for (auto name : names) {
+        entry.export_offsets.push_back(
+            static_cast<std::uint32_t>(entry.export_names.size()));
+        entry.export_names += name;
+        entry.export_names += '\0';
+    }
+    for (auto& name : elf.needed()) {
+        entry.needed.emplace_back(name);
+    }
+#elif defined(__APPLE__)
+    entry.is_library = entry.path.extension() == ".dylib";
+#else
+    entry.is_library = entry.path.extension() == ".dll";
+#endif
+}
+
+bool by_path(const manifest_entry& lhs, const manifest_entry& rhs) {
+    return lhs.path < rhs.path;
+}
+
+// Every offset has to point at the start of a NUL terminated name, or else
+// export_name would read past the end
+bool valid_exports(const manifest_entry& e) {
+    if (e.export_offsets.empty()) {
+        return true;
+    }
+    if (e.export_names.empty() || e.export_names.back() != '\0') {
+        return false;
+    }
+    for (auto offset : e.export_offsets) {
+        if (offset >= e.export_names.size()
+            || (offset > 0 && e.export_names[offset - 1] != '\0')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}   // namespace
+
+plugin_manifest::plugin_manifest(fs::path cache_file)
+    : _cache_file {std::move(cache_file)} {
+    _load();
+}
+
+void plugin_manifest::_load() {
+    std::ifstream in {_cache_file, std::ios::binary | std::ios::ate};
+    if (not in) {
+        return;
+    }
+    std::string bytes(static_cast<std::size_t>(in.tellg()), '\0');
+    in.seekg(0);
+    if (not in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()))
+        || bytes.size() < sizeof(magic)
+        || bytes.compare(0, sizeof(magic), magic, sizeof(magic)) != 0) {
+        return;
+    }
+
+    reader r {bytes};
+    std::vector<manifest_entry> entries;
+    for (auto count = r.u64(); r.ok() && count > 0; --count) {
+        auto& e          = entries.emplace_back();
+        e.path           = fs::u8path(r.string());
+        e.size           = r.u64();
+        e.mtime          = static_cast<std::int64_t>(r.u64());
+        e.is_library     = r.u64() != 0;
+        e.build_id       = r.string();
+        e.export_names   = r.string();
+        e.export_offsets = r.u32s();
+        e.needed         = r.strings();
+        if (r.ok() && not valid_exports(e)) {
+            return;
+        }
+    }
+    if (r.ok()) {
+        std::sort(entries.begin(), entries.end(), by_path);
+        _entries = std::move(entries);
+    }
+}
+
+std::size_t plugin_manifest::refresh(const fs::path& directory) {
+    std::vector<manifest_entry> current;
+    std::error_code ec;
+    for (fs::directory_iterator it {directory, ec}, end; not ec && it != end;
+         it.increment(ec)) {
+        std::error_code entry_ec;
+        if (not it->is_regular_file(entry_ec)) {
+            continue;
+        }
+        auto size  = it->file_size(entry_ec);
+        auto mtime = it->last_write_time(entry_ec);
+        if (entry_ec) {
+            continue;
+        }
+
+        auto& e = current.emplace_back();
+        e.path  = it->path();
+        e.size  = size;
+        e.mtime = mtime.time_since_epoch().count();
+    }
+    std::sort(current.begin(), current.end(), by_path);
+
+    // Spelled the way directory_iterator spells the parents of its paths,
+    // whatever trailing separators directory has
+    auto parent = (directory / "x").parent_path();
+
+    std::vector<manifest_entry> merged;
+    std::vector<manifest_entry> previous;
+    for (auto& e : _entries) {
+        if (e.path.parent_path() == parent) {
+            previous.push_back(std::move(e));
+        } else {
+            merged.push_back(std::move(e));
+        }
+    }
+
+    // Carry over what we knew about files that haven't changed, and parse the
+    // rest
+    std::vector<std::size_t> stale;
+    std::size_t still_there = 0;
+    for (std::size_t i = 0; i < current.size(); ++i) {
+        auto& e   = current[i];
+        auto prev = std::lower_bound(previous.begin(), previous.end(), e,
+                                     by_path);
+        auto seen = prev != previous.end() && prev->path == e.path;
+        still_there += seen;
+        if (seen && prev->size == e.size && prev->mtime == e.mtime) {
+            e = std::move(*prev);
+        } else {
+            stale.push_back(i);
+        }
+    }
+    detail::parallel_for(stale.size(),
+                         [&](std::size_t i) { parse(current[stale[i]]); });
+
+    auto removed = previous.size() - still_there;
+
+    for (auto& e : current) {
+        merged.push_back(std::move(e));
+    }
+    std::sort(merged.begin(), merged.end(), by_path);
+    _entries = std::move(merged);
+    return stale.size() + removed;
+}
+
+bool plugin_manifest::save() const {
+    writer w;
+    w.bytes().append(magic, sizeof(magic));
+    w.u64(_entries.size());
+    for (auto& e : _entries) {
+        w.string(e.path.u8string());
+        w.u64(e.size);
+        w.u64(static_cast<std::uint64_t>(e.mtime));
+        w.u64(e.is_library);
+        w.string(e.build_id);
+        w.string(e.export_names);
+        w.u32s(e.export_offsets);
+        w.strings(e.needed);
+    }
+
+    // Written next to the real thing and renamed over it, so readers never
+    // see half a manifest
+    auto temp = _cache_file;
+    temp += ".tmp";
+    {
+        std::ofstream out {temp, std::ios::binary | std::ios::trunc};
+        out.write(w.bytes().data(),
+                  static_cast<std::streamsize>(w.bytes().size()));
+        if (not out.flush()) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(temp, _cache_file, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+const manifest_entry* plugin_manifest::find(const fs::path& path) const {
+    manifest_entry key;
+    key.path = path;
+    auto it  = std::lower_bound(_entries.begin(), _entries.end(), key, by_path);
+    return it != _entries.end() && it->path == path ? &*it : nullptr;
+}
+
+std::vector<fs::path> plugin_manifest::find_plugins(
+    const std::vector<std::string>& required_exports) const {
+    std::vector<fs::path> plugins;
+    for (auto& e : _entries) {
+        if (not e.is_library) {
+            continue;
+        }
+#if REIJI_PLATFORM_ELF
+        auto exports_all = std::all_of(
+            required_exports.begin(), required_exports.end(),
+            [&](const std::string& name) { return e.exports(name); });
+        if (not exports_all) {
+            continue;
+        }
+#endif
+        plugins.push_back(e.path);
+    }
+    return plugins;
+}
+
+bool manifest_entry::exports(std::string_view name) const {
+    auto it = std::lower_bound(
+        export_offsets.begin(), export_offsets.end(), name,
+        [&](std::uint32_t offset, std::string_view n) {
+            return std::string_view {export_names.c_str() + offset} < n;
+        });
+    return it != export_offsets.end()
+           && std::string_view {export_names.c_str() + *it} == name;
+}
+
+}   // namespace reiji
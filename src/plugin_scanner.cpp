@@ -0,0 +1,79 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+// clang-format off
+#include <reiji/plugin_scanner.hpp>
+#include "elf.hpp"
+#include "parallel_for.hpp"
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#include <algorithm>   // std::sort
+#include <string_view>
+#include <system_error>
+#include <unordered_set>
+
+namespace reiji {
+
+namespace {
+
+bool exports_everything(const fs::path& path,
+                        const std::vector<std::string>& required_exports) {
+#if REIJI_PLATFORM_ELF
+    detail::elf_file elf {path};
+    if (not elf.valid()) {
+        return false;
+    }
+
+    std::unordered_set<std::string_view> missing {required_exports.begin(),
+                                                  required_exports.end()};
+    for (auto& sym : elf.exported_symbols()) {
+        if (missing.erase(sym.name) && missing.empty()) {
+            break;
+        }
+    }
+    return missing.empty();
+#else
+    (void)required_exports;
+#    if defined(__APPLE__)
+    return path.extension() == ".dylib";
+#    else
+    return path.extension() == ".dll";
+#    endif
+#endif
+}
+
+}   // namespace
+
+std::vector<fs::path>
+find_plugins(const fs::path& directory,
+             const std::vector<std::string>& required_exports) {
+    std::vector<fs::path> candidates;
+    std::error_code ec;
+    for (fs::directory_iterator it {directory, ec}, end; not ec && it != end;
+         it.increment(ec)) {
+        if (it->is_regular_file(ec)) {
+            candidates.push_back(it->path());
+        }
+    }
+
+    // Every candidate gets a slot nobody else writes to. std::vector<bool>
+    // would share bytes between slots, hence the chars.
+    std::vector<char> accepted(candidates.size(), 0);
+    detail::parallel_for(candidates.size(), [&](std::size_t i) {
+        accepted[i] = exports_everything(candidates[i], required_exports);
+    });
+
+    std::vector<fs::path> plugins;
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (accepted[i]) {
+            plugins.push_back(std::move(candidates[i]));
+        }
+    }
+    std::sort(plugins.begin(), plugins.end());
+    return plugins;
+}
+
+}   // namespace reiji
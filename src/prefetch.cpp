@@ -0,0 +1,187 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+// clang-format off
+#include <reiji/prefetch.hpp>
+#include "elf.hpp"
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if REIJI_PLATFORM_ELF
+#    include <algorithm>   // std::find
+#    include <cstdlib>     // std::getenv
+#    include <deque>
+#    include <fcntl.h>
+#    include <link.h>
+#    include <string>
+#    include <string_view>
+#    include <system_error>
+#    include <unistd.h>
+#    include <unordered_set>
+#endif
+
+#include <utility>   // std::move
+
+namespace reiji {
+
+#if REIJI_PLATFORM_ELF
+namespace {
+
+struct loaded_objects {
+    // Sonames (well, file names) of everything currently mapped into the
+    // process, and the directories they came from
+    std::unordered_set<std::string> names;
+    std::vector<fs::path> dirs;
+};
+
+loaded_objects find_loaded_objects() {
+    loaded_objects objects;
+    ::dl_iterate_phdr(
+        [](::dl_phdr_info* info, std::size_t, void* data) {
+            auto& objects = *static_cast<loaded_objects*>(data);
+            if (not info->dlpi_name || not *info->dlpi_name) {
+                return 0;
+            }
+
+            fs::path path {info->dlpi_name};
+            objects.names.insert(path.filename().string());
+            auto dir = path.parent_path();
+            if (not dir.empty()
+                && std::find(objects.dirs.begin(), objects.dirs.end(), dir)
+                       == objects.dirs.end()) {
+                objects.dirs.push_back(std::move(dir));
+            }
+            return 0;
+        },
+        &objects);
+    return objects;
+}
+
+// Splits a DT_RPATH/DT_RUNPATH/LD_LIBRARY_PATH style list, expanding $ORIGIN
+std::vector<fs::path> split_search_path(std::string_view list,
+                                        const fs::path& origin) {
+    std::vector<fs::path> dirs;
+    while (not list.empty()) {
+        auto colon = list.find_first_of(":;");
+        std::string dir {list.substr(0, colon)};
+        list.remove_prefix(colon == list.npos ? list.size() : colon + 1);
+
+        for (std::string_view token : {"${ORIGIN}", "$ORIGIN"}) {
+            for (auto pos = dir.find(token); pos != dir.npos;
+                 pos      = dir.find(token)) {
+                dir.replace(pos, token.size(), origin.string());
+            }
+        }
+        if (not dir.empty()) {
+            dirs.emplace_back(std::move(dir));
+        }
+    }
+    return dirs;
+}
+
+// posix_fadvise only queues the reads, which lets the kernel fetch every file
+// of the closure in parallel while we go on parsing
+bool start_readahead(const fs::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    (void)::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    ::close(fd);
+    return true;
+}
+
+fs::path find_in(const std::vector<fs::path>& dirs, std::string_view name) {
+    std::error_code ec;
+    for (auto& dir : dirs) {
+        auto candidate = dir / name;
+        if (fs::is_regular_file(candidate, ec)) {
+            return candidate;
+        }
+    }
+    return {};
+}
+
+}   // namespace
+#endif
+
+std::vector<fs::path> prefetch(const fs::path& path) {
+    std::vector<fs::path> prefetched;
+#if REIJI_PLATFORM_ELF
+    auto loaded = find_loaded_objects();
+
+    auto ld_library_path = std::getenv("LD_LIBRARY_PATH");
+    auto env_dirs =
+        split_search_path(ld_library_path ? ld_library_path : "", fs::path {});
+
+    auto default_dirs = loaded.dirs;
+    for (auto dir : {"/lib64", "/usr/lib64", "/lib", "/usr/lib"}) {
+        default_dirs.emplace_back(dir);
+    }
+
+    std::deque<fs::path> pending;
+    if (path.has_parent_path()) {
+        pending.push_back(path);
+    } else if (auto found = find_in(env_dirs, path.native());
+               not found.empty()) {
+        pending.push_back(std::move(found));
+    } else {
+        pending.push_back(find_in(default_dirs, path.native()));
+    }
+
+    std::unordered_set<std::string> seen;
+    while (not pending.empty()) {
+        auto current = std::move(pending.front());
+        pending.pop_front();
+        if (current.empty() || not seen.insert(current.string()).second
+            || not start_readahead(current)) {
+            continue;
+        }
+        prefetched.push_back(current);
+
+        detail::elf_file elf {current};
+        if (not elf.valid()) {
+            continue;
+        }
+
+        // Like the loader, DT_RPATH is ignored when DT_RUNPATH is present
+        auto origin  = current.parent_path();
+        auto rpath   = elf.runpath().empty()
+                           ? split_search_path(elf.rpath(), origin)
+                           : std::vector<fs::path> {};
+        auto runpath = split_search_path(elf.runpath(), origin);
+
+        for (auto name : elf.needed()) {
+            if (loaded.names.count(std::string {name})) {
+                continue;   // already mapped, so already in the page cache
+            }
+
+            if (name.find('/') != name.npos) {
+                pending.emplace_back(name);
+                continue;
+            }
+
+            fs::path found;
+            for (auto dirs : {&rpath, &env_dirs, &runpath, &default_dirs}) {
+                found = find_in(*dirs, name);
+                if (not found.empty()) {
+                    break;
+                }
+            }
+            pending.push_back(std::move(found));
+        }
+    }
+#else
+    (void)path;
+#endif
+    return prefetched;
+}
+
+std::future<std::vector<fs::path>> prefetch_async(fs::path path) {
+    return std::async(std::launch::async,
+                      [path = std::move(path)] { return prefetch(path); });
+}
+
+}   // namespace reiji
@@ -0,0 +1,215 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#include "static_module.hpp"
+
+#include <algorithm>   // std::sort, std::find, std::adjacent_find
+#include <atomic>
+#include <cstring>   // std::strlen, std::memcmp
+#include <limits>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace reiji {
+
+namespace detail {
+
+namespace {
+
+constexpr auto empty_slot = std::numeric_limits<std::uint32_t>::max();
+// Past this many attempts for one bucket we give up on the perfect hash
+constexpr std::uint32_t max_displacement = 1u << 16;
+
+// The finalizer of splitmix64, to spread the 32 bits of GNU hash around
+constexpr std::uint64_t mix(std::uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    x ^= x >> 31;
+    return x;
+}
+
+// Maps x onto [0, n) without a division
+constexpr std::size_t reduce(std::uint32_t x, std::size_t n) noexcept {
+    return static_cast<std::size_t>((std::uint64_t {x} * n) >> 32);
+}
+
+constexpr std::size_t bucket_of(std::uint64_t x, std::size_t buckets) noexcept {
+    return reduce(static_cast<std::uint32_t>(x >> 32), buckets);
+}
+
+constexpr std::size_t slot_of(std::uint64_t x,
+                              std::uint32_t displacement,
+                              std::size_t slots) noexcept {
+    return reduce(static_cast<std::uint32_t>(mix(x + displacement)), slots);
+}
+
+bool build_perfect_hash(static_module_table& table) {
+    auto n       = table.entries.size();
+    auto buckets = (n + 3) / 4;
+    auto slots   = n + n / 4;
+
+    std::vector<std::vector<std::uint32_t>> members(buckets);
+    for (std::uint32_t i = 0; i < n; ++i) {
+        members[bucket_of(mix(table.entries[i].hash), buckets)].push_back(i);
+    }
+
+    // Biggest buckets first, while there's still plenty of room
+    std::vector<std::uint32_t> order(buckets);
+    for (std::uint32_t i = 0; i < buckets; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](auto lhs, auto rhs) {
+        return members[lhs].size() > members[rhs].size();
+    });
+
+    table.displacements.assign(buckets, 0);
+    table.slots.assign(slots, empty_slot);
+    std::vector<std::size_t> taken;
+    for (auto bucket : order) {
+        auto& indices = members[bucket];
+        if (indices.empty()) {
+            break;
+        }
+
+        std::uint32_t d = 0;
+        for (; d < max_displacement; ++d) {
+            taken.clear();
+            for (auto i : indices) {
+                auto slot = slot_of(mix(table.entries[i].hash), d, slots);
+                if (table.slots[slot] != empty_slot
+                    || std::find(taken.begin(), taken.end(), slot)
+                           != taken.end()) {
+                    break;
+                }
+                taken.push_back(slot);
+            }
+            if (taken.size() == indices.size()) {
+                break;
+            }
+        }
+        if (d == max_displacement) {
+            return false;
+        }
+
+        table.displacements[bucket] = d;
+        for (std::size_t j = 0; j < indices.size(); ++j) {
+            table.slots[taken[j]] = indices[j];
+        }
+    }
+    return true;
+}
+
+struct registry {
+    std::mutex mutex;
+    // Keyed by views of the registered table's own name, so that lookups
+    // don't have to allocate (unordered_map only gets heterogeneous lookup in
+    // C++20)
+    std::unordered_map<std::string_view, const static_module_table*> modules;
+    // Lets open() skip the lock in programs that don't use static modules
+    std::atomic<bool> used {false};
+};
+
+registry& get_registry() {
+    static registry r;
+    return r;
+}
+
+}   // namespace
+
+static_module_table::static_module_table(const static_symbol* symbols,
+                                         std::size_t count) {
+    entries.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto length = std::strlen(symbols[i].name);
+        entries.push_back({symbols[i].name, length,
+                           gnu_hash(symbols[i].name, length),
+                           symbols[i].address, symbols[i].size});
+    }
+
+    // Names sharing a hash (duplicates included) can't be told apart by any
+    // displacement, such tables get searched one name at a time
+    std::vector<std::uint32_t> hashes;
+    for (auto& e : entries) {
+        hashes.push_back(e.hash);
+    }
+    std::sort(hashes.begin(), hashes.end());
+    auto unique = std::adjacent_find(hashes.begin(), hashes.end())
+                  == hashes.end();
+
+    perfect = not entries.empty() && unique && build_perfect_hash(*this);
+    if (not perfect) {
+        displacements.clear();
+        slots.clear();
+    }
+}
+
+const static_module_table::entry*
+static_module_table::find(const hashed_name& name) const noexcept {
+    auto matches = [&](const entry& e) {
+        return e.hash == name.hash && e.length == name.length
+               && std::memcmp(e.name, name.name, name.length) == 0;
+    };
+
+    if (perfect) {
+        auto x     = mix(name.hash);
+        auto d     = displacements[bucket_of(x, displacements.size())];
+        auto index = slots[slot_of(x, d, slots.size())];
+        if (index != empty_slot && matches(entries[index])) {
+            return &entries[index];
+        }
+        return nullptr;
+    }
+
+    for (auto& e : entries) {
+        if (matches(e)) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+const static_module_table* find_static_module(const char* name) {
+    auto& r = get_registry();
+    // A null name asks for the main program, which is never a module
+    if (not name || not r.used.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    std::string_view key {name};
+    std::lock_guard lock {r.mutex};
+    auto it = r.modules.find(key);
+    return it != r.modules.end() ? it->second : nullptr;
+}
+
+}   // namespace detail
+
+static_module::static_module(const char* name,
+                             const static_symbol* symbols,
+                             std::size_t count)
+    : _table {std::make_unique<detail::static_module_table>(symbols, count)} {
+    _table->name = name;
+
+    auto& r = detail::get_registry();
+    std::lock_guard lock {r.mutex};
+    // A module registered under the same name before us may go away first,
+    // so the key has to be rebuilt from our own copy of the name
+    r.modules.erase(_table->name);
+    r.modules.emplace(_table->name, _table.get());
+    r.used.store(true, std::memory_order_release);
+}
+
+static_module::~static_module() noexcept {
+    auto& r = detail::get_registry();
+    std::lock_guard lock {r.mutex};
+    auto it = r.modules.find(_table->name);
+    if (it != r.modules.end() && it->second == _table.get()) {
+        r.modules.erase(it);
+    }
+}
+
+}   // namespace reiji
@@ -0,0 +1,48 @@
+// Copyright Mițca Dumitru 2021 - present
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uint32_t
+#include <string>
+#include <vector>
+
+#include <reiji/hashed_name.hpp>
+#include <reiji/static_module.hpp>
+
+namespace reiji::detail {
+
+struct static_module_table final {
+    struct entry {
+        const char* name;
+        std::size_t length;
+        std::uint32_t hash;
+        void* address;
+        std::size_t size;
+    };
+
+    static_module_table(const static_symbol* symbols, std::size_t count);
+
+    const entry* find(const hashed_name& name) const noexcept;
+
+    // Owned, as the registry's keys point into it
+    std::string name;
+    std::vector<entry> entries;
+
+    // A "hash and displace" perfect hash: every name's bucket has a
+    // displacement which, mixed into the name's hash, sends it to its own
+    // slot. Only used if building it worked, names are searched one by one
+    // otherwise.
+    bool perfect {false};
+    std::vector<std::uint32_t> displacements;
+    std::vector<std::uint32_t> slots;
+};
+
+// The module registered under name, or nullptr (which is also what a null
+// name gets)
+const static_module_table* find_static_module(const char* name);
+
+}   // namespace reiji::detail
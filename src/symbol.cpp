@@ -6,6 +6,8 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <utility>
 
 #include <reiji/symbol.hpp>
 #include <reiji/unique_shared_lib.hpp>
@@ -22,6 +24,28 @@ void symbol_base::remove_self_from_origins_symbol_vector() noexcept {
         return;
     }
 
+    if (auto slot = _slot_in_origin()) {
+        *slot = nullptr;
+    }
+}
+
+void symbol_base::swap(symbol_base& other) noexcept {
+    auto our_slot   = _origin ? _slot_in_origin() : nullptr;
+    auto their_slot = other._origin ? other._slot_in_origin() : nullptr;
+
+    using std::swap;
+    swap(_uid, other._uid);
+    swap(_origin, other._origin);
+
+    if (our_slot) {
+        *our_slot = &other;
+    }
+    if (their_slot) {
+        *their_slot = this;
+    }
+}
+
+symbol_base** symbol_base::_slot_in_origin() noexcept {
     auto& origin_symbols = _origin->_symbols;
 
     // Let's make sure none of the removed symbols exist in the _symbols vector
@@ -32,19 +56,25 @@ void symbol_base::remove_self_from_origins_symbol_vector() noexcept {
 
     // We can binary search to find ourselves as we always push to the back of
     // the _symbols vector in unique_shared_lib
-    std::size_t low = 0, high = origin_symbols.size() - 1, mid;
-    while (low <= high) {
-        mid = (low + high) / 2;
-
-        if (origin_symbols[mid]->_uid > _uid) {
-            high = mid - 1;
-        } else if (origin_symbols[mid]->_uid < _uid) {
-            low = mid + 1;
-        } else {
-            break;   // found ourselves!
+    auto it = std::lower_bound(
+        origin_symbols.begin(), origin_symbols.end(), _uid,
+        [](symbol_base* sym, std::uint64_t uid) { return sym->_uid < uid; });
+    if (it == origin_symbols.end() || (*it)->_uid != _uid) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+void symbol_base::_take_over(symbol_base& other) noexcept {
+    // The slot has to be found while other still has its uid, as that's what
+    // the _symbols vector is sorted by
+    if (other._origin) {
+        if (auto slot = other._slot_in_origin()) {
+            *slot = this;
         }
     }
-    origin_symbols[mid] = nullptr;
+    _uid    = std::exchange(other._uid, 0);
+    _origin = std::exchange(other._origin, nullptr);
 }
 
 }   // namespace reiji::detail
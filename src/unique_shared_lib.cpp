@@ -7,6 +7,12 @@
 // Disable clang-format so it doesn't reorder these headers
 // clang-format off
 #include <reiji/unique_shared_lib.hpp>
+#include <reiji/fast_exit.hpp>
+#include "deferred_close.hpp"
+#include "elf.hpp"
+#include "handle_pool_state.hpp"
+#include "open_handles.hpp"
+#include "static_module.hpp"
 #include <reiji/detail/push_platform_detection_macros.hpp>
 // clang-format on
 
@@ -22,9 +28,13 @@
 #    endif
 #elif REIJI_PLATFORM_POSIX
 #    include <dlfcn.h>
+#    if REIJI_PLATFORM_ELF
+#        include <link.h>   // ElfW
+#    endif
 #endif
 
 #include <algorithm>   // std::remove
+#include <cstring>     // std::strcmp, std::strlen
 #include <utility>     // std::move, std::exchange
 
 namespace reiji {
@@ -52,6 +62,24 @@ static inline std::string get_error(DWORD err_code) {
 }
 #endif
 
+namespace detail {
+
+std::string close_native_handle(void* handle) {
+#if REIJI_PLATFORM_WINDOWS
+    if (not ::FreeLibrary(reinterpret_cast<::HMODULE>(handle))) {
+        return reiji::get_error(::GetLastError());
+    }
+#elif REIJI_PLATFORM_POSIX
+    if (::dlclose(handle)) {
+        auto err = ::dlerror();
+        return err ? err : "";
+    }
+#endif
+    return "";
+}
+
+}   // namespace detail
+
 unique_shared_lib::unique_shared_lib(unique_shared_lib&& other) noexcept {
     *this = std::move(other);
 }
@@ -60,10 +88,21 @@ unique_shared_lib&
 unique_shared_lib::operator=(unique_shared_lib&& other) noexcept {
     if (this != &other) {
         close();
-        _handle   = std::exchange(other._handle, nullptr);
-        _error    = std::move(other._error);
-        _symbols  = std::move(other._symbols);
-        _curr_uid = std::exchange(other._curr_uid, 0);
+        _handle       = std::exchange(other._handle, nullptr);
+        _error        = std::move(other._error);
+        _symbols      = std::move(other._symbols);
+        _curr_uid     = std::exchange(other._curr_uid, 0);
+        _close_mode   = other._close_mode;
+        _leak_on_exit = other._leak_on_exit;
+        _image        = std::move(other._image);
+        _pool         = std::move(other._pool);
+        _static       = std::exchange(other._static, nullptr);
+
+        for (auto sym : _symbols) {
+            if (sym) {
+                sym->_origin = this;
+            }
+        }
     }
     return *this;
 }
@@ -73,9 +112,15 @@ unique_shared_lib::~unique_shared_lib() noexcept {
 }
 
 void unique_shared_lib::open(const char* filename, flags_type flags) {
-    if (_handle) {
+    if (_handle || _static) {
         close();
     }
+
+    _static = detail::find_static_module(filename);
+    if (_static) {
+        return;
+    }
+
 #if REIJI_PLATFORM_WINDOWS
 #    if REIJI_ON_UWP
     (void)flags;   // As far as I can see, we can't pass flags to
@@ -102,14 +147,22 @@ void unique_shared_lib::open(const char* filename, flags_type flags) {
         _error   = err ? err : _error;
     }
 #endif
+    if (_handle) {
+        detail::register_open_handle(_handle);
+    }
 }
 
 void unique_shared_lib::open(const fs::path& path, flags_type flags) {
-    if (_handle) {
+    if (_handle || _static) {
         close();
     }
 
 #if REIJI_PLATFORM_WINDOWS
+    _static = detail::find_static_module(path.u8string().c_str());
+    if (_static) {
+        return;
+    }
+
     // On windows, path::c_str returns a wchar_t*, which is good as it means we
     // don't have to do any conversions
 #    if REIJI_ON_UWP
@@ -122,6 +175,8 @@ void unique_shared_lib::open(const fs::path& path, flags_type flags) {
 #    endif
     if (not _handle) {
         _error = reiji::get_error(::GetLastError());
+    } else {
+        detail::register_open_handle(_handle);
     }
 #elif REIJI_PLATFORM_POSIX
     // We can fall back on the (char*, flags_type) overload on POSIX platforms
@@ -129,25 +184,15 @@ void unique_shared_lib::open(const fs::path& path, flags_type flags) {
 #endif
 }
 
-void unique_shared_lib::close() {
-    if (not _handle) {
-        return;
+void unique_shared_lib::close(close_mode mode) {
+    if (_leak_on_exit && fast_exit_enabled()) {
+        _leak();
+    } else {
+        _unload(mode);
     }
+}
 
-    _error = "";
-
-#if REIJI_PLATFORM_WINDOWS
-    if (not ::FreeLibrary(reinterpret_cast<::HMODULE>(_handle))) {
-        _error = reiji::get_error(::GetLastError());
-    }
-#elif REIJI_PLATFORM_POSIX
-    if (::dlclose(_handle)) {
-        auto err = ::dlerror();
-        _error   = err ? err : "";
-    }
-#endif
-    _handle = nullptr;
-
+void unique_shared_lib::_invalidate_symbols() noexcept {
     for (std::size_t i = 0; i < _symbols.size(); i++) {
         if (_symbols[i]) {
             _symbols[i]->_invalidate();
@@ -157,16 +202,84 @@ void unique_shared_lib::close() {
     _curr_uid = 0;
 }
 
+void unique_shared_lib::_leak() {
+    if (not _handle && not _static) {
+        return;
+    }
+
+    // Symbols point back at us, so they have to be let go of even though the
+    // code they point at stays around
+    _invalidate_symbols();
+    _error  = "";
+    _static = nullptr;
+    if (auto handle = std::exchange(_handle, nullptr)) {
+        _image.reset();
+        detail::unregister_open_handle(handle);
+        // The pool still counts us as a user, so it never closes the handle
+        // either
+        _pool.reset();
+    }
+}
+
+void unique_shared_lib::_unload(close_mode mode) {
+    if (not _handle && not _static) {
+        return;
+    }
+
+    _invalidate_symbols();
+
+    if (_static) {
+        // Static modules never go anywhere
+        _static = nullptr;
+        _error  = "";
+        return;
+    }
+
+    auto handle = std::exchange(_handle, nullptr);
+    _image.reset();
+    detail::unregister_open_handle(handle);
+
+    if (auto pool = std::move(_pool)) {
+        _error = pool->release(handle, mode);
+    } else if (mode == close_mode::deferred) {
+        // Errors from the reclaimer thread have nowhere to go, so last_error()
+        // stays empty for deferred closes
+        _error = "";
+        detail::defer_close(handle);
+    } else {
+        _error = detail::close_native_handle(handle);
+    }
+}
+
 void unique_shared_lib::swap(unique_shared_lib& other) {
     using std::swap;
+    swap(_close_mode, other._close_mode);
+    swap(_leak_on_exit, other._leak_on_exit);
     swap(_handle, other._handle);
     swap(_curr_uid, other._curr_uid);
     swap(_error, other._error);
     swap(_symbols, other._symbols);
+    swap(_image, other._image);
+    swap(_pool, other._pool);
+    swap(_static, other._static);
+
+    for (auto sym : _symbols) {
+        if (sym) {
+            sym->_origin = this;
+        }
+    }
+    for (auto sym : other._symbols) {
+        if (sym) {
+            sym->_origin = &other;
+        }
+    }
 }
 
 unique_shared_lib::native_symbol
 unique_shared_lib::_get_symbol(const char* sym_name) {
+    if (_static) {
+        return _get_symbol(hashed_name {sym_name, std::strlen(sym_name)});
+    }
     if (not _handle) {
         using namespace std::string_literals;
         _error = "Cannot load symbol '"s + sym_name
@@ -174,12 +287,7 @@ unique_shared_lib::_get_symbol(const char* sym_name) {
         return nullptr;
     }
 
-    if (_curr_uid % 10 == 0 && _curr_uid > 0) {
-        // Every so often we want to clean up the _symbols vector of _symbols
-        // that got destroyed before we did
-        _symbols.erase(std::remove(_symbols.begin(), _symbols.end(), nullptr),
-                       _symbols.end());
-    }
+    _prune_symbols();
 
 #if REIJI_PLATFORM_WINDOWS
     native_symbol ret = reinterpret_cast<void*>(
@@ -199,4 +307,231 @@ unique_shared_lib::_get_symbol(const char* sym_name) {
 #endif
 }
 
+unique_shared_lib::native_symbol
+unique_shared_lib::_get_symbol(const hashed_name& sym_name) {
+    if (_static) {
+        auto ret = _get_local_symbol(sym_name);
+        if (not ret) {
+            using namespace std::string_literals;
+            _error = "Module '"s + _static->name + "' has no symbol '"
+                     + std::string {sym_name.name, sym_name.length} + "'.";
+        }
+        return ret;
+    }
+
+    auto result = gnu_hash_lookup::unusual;
+    auto ret    = _lookup_gnu_hash(sym_name, result);
+    if (result != gnu_hash_lookup::found) {
+        // Misses still go through dlsym, as it also searches the library's
+        // dependencies and takes care of reporting the error
+        return _get_symbol(sym_name.name);
+    }
+
+    _prune_symbols();
+    return ret;
+}
+
+unique_shared_lib::native_symbol
+unique_shared_lib::_get_local_symbol(const hashed_name& sym_name) {
+    if (_static) {
+        auto entry = _static->find(sym_name);
+        if (not entry) {
+            return nullptr;
+        }
+        _prune_symbols();
+        return entry->address;
+    }
+
+    auto result = gnu_hash_lookup::unusual;
+    auto ret    = _lookup_gnu_hash(sym_name, result);
+    switch (result) {
+    case gnu_hash_lookup::found:
+        _prune_symbols();
+        return ret;
+    case gnu_hash_lookup::missing:
+        return nullptr;
+    case gnu_hash_lookup::unusual:
+        break;
+    }
+
+    // dlsym doesn't know about "missing", so put back whatever error was
+    // there before. It also searches the library's dependencies, so what it
+    // finds there doesn't count either.
+    auto error = _error;
+    ret        = _get_symbol(sym_name.name);
+    if (not ret || not _defines(ret)) {
+        _error = std::move(error);
+        return nullptr;
+    }
+    return ret;
+}
+
+bool unique_shared_lib::_defines(native_symbol sym) const {
+#if REIJI_PLATFORM_WINDOWS && !REIJI_ON_UWP
+    // GetProcAddress follows forwarded exports into other modules
+    constexpr ::DWORD flags = GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS
+                              | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT;
+    ::HMODULE owner         = nullptr;
+    if (not ::GetModuleHandleExW(flags, static_cast<::LPCWSTR>(sym), &owner)) {
+        return true;
+    }
+    return owner == static_cast<::HMODULE>(_handle);
+#elif REIJI_PLATFORM_ELF
+    // The dynamic section is somewhere inside our own image, so dladdr puts
+    // it and everything we define at the same base. Addresses dladdr can't
+    // place at all (e.g. TLS variables) are given the benefit of the doubt.
+    ::link_map* map = nullptr;
+    ::Dl_info ours {}, theirs {};
+    if (::dlinfo(_handle, RTLD_DI_LINKMAP, &map) || not map
+        || not ::dladdr(map->l_ld, &ours) || not ::dladdr(sym, &theirs)) {
+        return true;
+    }
+    return ours.dli_fbase == theirs.dli_fbase;
+#else
+    (void)sym;
+    return true;
+#endif
+}
+
+const detail::loaded_image* unique_shared_lib::_loaded_image() {
+#if REIJI_PLATFORM_ELF
+    if (_handle && not _image) {
+        _image = std::make_shared<const detail::loaded_image>(_handle);
+    }
+    return _image && _image->valid() ? _image.get() : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+unique_shared_lib::native_symbol
+unique_shared_lib::_lookup_gnu_hash(const hashed_name& sym_name,
+                                    gnu_hash_lookup& result) {
+    result = gnu_hash_lookup::unusual;
+#if REIJI_PLATFORM_ELF
+    auto loaded = _loaded_image();
+    if (not loaded || not loaded->gnu_hash) {
+        return nullptr;
+    }
+
+    // See https://flapenguin.me/elf-dt-gnu-hash for a description of the
+    // layout of .gnu.hash
+    auto& image     = *loaded;
+    auto gnu_hash   = image.gnu_hash;
+    auto nbuckets   = gnu_hash[0];
+    auto symoffset  = gnu_hash[1];
+    auto bloom_size = gnu_hash[2];
+    auto shift      = gnu_hash[3];
+    auto bloom      = reinterpret_cast<const ElfW(Addr)*>(gnu_hash + 4);
+    auto buckets = reinterpret_cast<const std::uint32_t*>(bloom + bloom_size);
+    auto chains  = buckets + nbuckets;
+
+    constexpr std::uint32_t bits = sizeof(ElfW(Addr)) * 8;
+    auto h                       = sym_name.hash;
+    auto word = bloom[(h / bits) & (bloom_size - 1)];
+    auto mask = (ElfW(Addr) {1} << (h % bits))
+                | (ElfW(Addr) {1} << ((h >> shift) % bits));
+
+    // Like dlsym, prefer a definition without a version, and otherwise take
+    // the default version if there's exactly one of those
+    std::uint32_t index = 0, versioned = 0, versioned_count = 0;
+    if ((word & mask) == mask && nbuckets) {
+        for (auto i = buckets[h % nbuckets]; i >= symoffset; ++i) {
+            auto chain_hash = chains[i - symoffset];
+            if ((chain_hash | 1) == (h | 1) && image.is_exported(i)
+                && std::strcmp(image.strtab + image.symtab[i].st_name,
+                               sym_name.name)
+                       == 0) {
+                auto version = image.versym ? image.versym[i] : 1;
+                if ((version & 0x7fff) <= 1) {
+                    index = i;
+                    break;
+                } else if (not(version & 0x8000) && versioned_count++ == 0) {
+                    versioned = i;
+                }
+            }
+            if (chain_hash & 1) {
+                break;
+            }
+        }
+    }
+    if (index == 0 && versioned_count == 1) {
+        index = versioned;
+    }
+
+    if (index == 0) {
+        // Ambiguous between several versions, or not defined here at all
+        result = versioned_count ? gnu_hash_lookup::unusual
+                                 : gnu_hash_lookup::missing;
+        return nullptr;
+    }
+
+    auto& sym = image.symtab[index];
+    auto type = ELF64_ST_TYPE(sym.st_info);
+    if (sym.st_shndx == SHN_ABS || type == STT_GNU_IFUNC || type == STT_TLS) {
+        return nullptr;
+    }
+
+    result = gnu_hash_lookup::found;
+    return reinterpret_cast<native_symbol>(image.base + sym.st_value);
+#else
+    (void)sym_name;
+    return nullptr;
+#endif
+}
+
+unique_shared_lib::native_symbol
+unique_shared_lib::_check_array_symbol(const char* sym_name,
+                                       native_symbol ret,
+                                       std::size_t element_size,
+                                       std::size_t extent,
+                                       std::size_t& count) {
+    count = extent;
+    if (not ret) {
+        return nullptr;
+    }
+
+    std::size_t size = 0;
+    if (_static) {
+        auto entry =
+            _static->find(hashed_name {sym_name, std::strlen(sym_name)});
+        size = entry ? entry->size : 0;
+    } else {
+#if defined(__GLIBC__)
+        // dladdr1 hands us the symbol table entry that matched, and with it
+        // the size of the object
+        ::Dl_info info {};
+        void* sym = nullptr;
+        if (::dladdr1(ret, &info, &sym, RTLD_DL_SYMENT) && sym
+            && info.dli_saddr == ret) {
+            size = static_cast<const ElfW(Sym)*>(sym)->st_size;
+        }
+#endif
+    }
+
+    using namespace std::string_literals;
+    if (size == 0 && extent == 0) {
+        _error = "Cannot determine the size of array '"s + sym_name + "'.";
+        return nullptr;
+    } else if (size != 0 && size < extent * element_size) {
+        _error = "Symbol '"s + sym_name + "' is smaller than the requested "
+                 "array type.";
+        return nullptr;
+    }
+
+    if (extent == 0) {
+        count = size / element_size;
+    }
+    return ret;
+}
+
+void unique_shared_lib::_prune_symbols() {
+    if (_curr_uid % 10 == 0 && _curr_uid > 0) {
+        // Every so often we want to clean up the _symbols vector of _symbols
+        // that got destroyed before we did
+        _symbols.erase(std::remove(_symbols.begin(), _symbols.end(), nullptr),
+                       _symbols.end());
+    }
+}
+
 }   // namespace reiji
@@ -0,0 +1,80 @@
+#include <doctest/doctest.h>
+
+#include <cstddef>
+
+// clang-format off
+#include <reiji/address_index.hpp>
+#include <reiji/unique_shared_lib.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if REIJI_PLATFORM_ELF
+#    include <dlfcn.h>
+#endif
+
+#if defined(__APPLE__)
+#    define LIB1_NAME "liblib1.dylib"
+#elif REIJI_PLATFORM_POSIX
+#    define LIB1_NAME "liblib1.so"
+#elif REIJI_PLATFORM_WINDOWS
+#    define LIB1_NAME "lib1.dll"
+#endif
+
+TEST_SUITE("address_index") {
+    TEST_CASE("an empty index finds nothing") {
+        reiji::address_index index;
+        int x = 0;
+        REQUIRE(index.empty());
+        REQUIRE_FALSE(index.lookup(&x));
+    }
+
+#if REIJI_PLATFORM_ELF
+    TEST_CASE("addresses map back to the symbol containing them") {
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        reiji::address_index index {lib};
+        REQUIRE_FALSE(index.empty());
+
+        auto table = lib.get_symbol<const int[4]>("table");
+        auto info  = index.lookup(table.data() + 3);
+        REQUIRE(info);
+        REQUIRE(info.name == "table");
+        REQUIRE(info.symbol_address == table.data());
+        REQUIRE(info.size == sizeof(int[4]));
+
+        // Past the end of table is no longer table
+        auto past = index.lookup(table.data() + 4);
+        REQUIRE(past.name != "table");
+
+        auto bar = lib.get_symbol<int>("bar");
+        ::Dl_info dl {};
+        REQUIRE(::dladdr(&*bar, &dl));
+        REQUIRE(index.lookup(&*bar).name == dl.dli_sname);
+    }
+
+    TEST_CASE("batched lookups agree with single lookups") {
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        reiji::address_index index {lib};
+        auto table = lib.get_symbol<const int[4]>("table");
+        auto bar   = lib.get_symbol<int>("bar");
+
+        // More than one group's worth, so the tail of the batch is covered
+        int local               = 0;
+        const void* addresses[] = {
+            table.data(),     &*bar,   &local, table.data() + 1,
+            nullptr,          &*bar,   &local, table.data() + 2,
+            table.data() + 3, nullptr,
+        };
+        constexpr auto count = sizeof(addresses) / sizeof(addresses[0]);
+        reiji::address_info results[count];
+        index.lookup(addresses, count, results);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            auto single = index.lookup(addresses[i]);
+            REQUIRE(results[i].name == single.name);
+            REQUIRE(results[i].symbol_address == single.symbol_address);
+        }
+        REQUIRE(results[3].name == "table");
+        REQUIRE_FALSE(results[2]);
+    }
+#endif
+}
@@ -0,0 +1,95 @@
+#include <doctest/doctest.h>
+
+#include <string>
+#include <vector>
+
+// clang-format off
+#include <reiji/cpu_features.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if defined(__APPLE__)
+#    define LIB1_NAME "liblib1.dylib"
+#    define LIB2_NAME "liblib2.dylib"
+#    define LIB3_NAME "liblib3.dylib"
+#elif REIJI_PLATFORM_POSIX
+#    define LIB1_NAME "liblib1.so"
+#    define LIB2_NAME "liblib2.so"
+#    define LIB3_NAME "liblib3.so"
+#elif REIJI_PLATFORM_WINDOWS
+#    define LIB1_NAME "lib1.dll"
+#    define LIB2_NAME "lib2.dll"
+#    define LIB3_NAME "lib3.dll"
+#endif
+
+namespace {
+
+// Stand ins for a baseline, an AVX2 and an AVX-512 build of one plugin, told
+// apart by which of them exports what
+const std::vector<reiji::library_variant> variants = {
+    {LIB1_NAME, reiji::cpu::none},
+    {LIB2_NAME, reiji::cpu::x86_64_v3},
+    {LIB3_NAME, reiji::cpu::x86_64_v4},
+};
+
+}   // namespace
+
+TEST_SUITE("cpu_features") {
+    TEST_CASE("the best supported variant gets picked") {
+        auto choice = reiji::open_best_variant(
+            variants, reiji::detail::default_flags, reiji::cpu::x86_64_v4);
+        REQUIRE(choice.index == 2);
+        REQUIRE(choice.library.get_symbol<int>("qux") != nullptr);
+    }
+
+    TEST_CASE("CPUs without AVX-512 fall back to the AVX2 build") {
+        auto choice = reiji::open_best_variant(
+            variants, reiji::detail::default_flags,
+            reiji::cpu::x86_64_v4 & ~reiji::cpu::avx512bw);
+        REQUIRE(choice.index == 1);
+        REQUIRE(choice.library.get_symbol<int>("baz") != nullptr);
+
+        choice = reiji::open_best_variant(variants,
+                                          reiji::detail::default_flags,
+                                          reiji::cpu::x86_64_v2);
+        REQUIRE(choice.index == 0);
+        REQUIRE(choice.library.get_symbol<int>("bar") != nullptr);
+    }
+
+    TEST_CASE("variants that fail to open are skipped") {
+        auto with_missing = variants;
+        with_missing.push_back({"this_library_does_not_exist",
+                                reiji::cpu::x86_64_v4 | reiji::cpu::avx512f});
+
+        auto choice = reiji::open_best_variant(
+            with_missing, reiji::detail::default_flags, reiji::cpu::x86_64_v4);
+        REQUIRE(choice.index == 2);
+        REQUIRE(choice.library.last_error().empty());
+
+        choice = reiji::open_best_variant({{"this_library_does_not_exist",
+                                            reiji::cpu::none}});
+        REQUIRE(choice.index == 1);
+        REQUIRE_FALSE(choice.library.last_error().empty());
+    }
+
+    TEST_CASE("nothing is opened when no variant is supported") {
+        auto choice = reiji::open_best_variant(
+            {{LIB3_NAME, reiji::cpu::x86_64_v4}}, reiji::detail::default_flags,
+            reiji::cpu::x86_64_v2);
+        REQUIRE(choice.index == 1);
+        REQUIRE(choice.library.get_symbol<int>("qux") == nullptr);
+    }
+
+    TEST_CASE("the running CPU's choice is consistent with its features") {
+        auto detected = reiji::detected_cpu_features();
+        REQUIRE(detected == reiji::detected_cpu_features());
+
+        auto choice = reiji::open_best_variant(variants);
+        REQUIRE(choice.index < variants.size());
+        REQUIRE((variants[choice.index].required & ~detected)
+                == reiji::cpu::none);
+        if ((reiji::cpu::x86_64_v4 & ~detected) != reiji::cpu::none) {
+            REQUIRE(choice.index != 2);
+        }
+    }
+}
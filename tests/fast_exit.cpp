@@ -0,0 +1,126 @@
+#include <doctest/doctest.h>
+
+#include <chrono>
+
+// clang-format off
+#include <reiji/fast_exit.hpp>
+#include <reiji/unique_shared_lib.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if REIJI_PLATFORM_POSIX
+#    include <dlfcn.h>
+#endif
+
+#if defined(__APPLE__)
+#    define LIB1_NAME "liblib1.dylib"
+#    define LIB3_NAME "liblib3.dylib"
+#elif REIJI_PLATFORM_POSIX
+#    define LIB1_NAME "liblib1.so"
+#    define LIB3_NAME "liblib3.so"
+#elif REIJI_PLATFORM_WINDOWS
+#    define LIB1_NAME "lib1.dll"
+#    define LIB3_NAME "lib3.dll"
+#endif
+
+namespace {
+
+// Fast exit is process wide, so every test turns it back off when it's done
+struct fast_exit_scope {
+    fast_exit_scope() { reiji::set_fast_exit(true); }
+    ~fast_exit_scope() { reiji::set_fast_exit(false); }
+};
+
+#if REIJI_PLATFORM_POSIX
+// Drops the references leaked libraries kept, so later tests get a freshly
+// loaded copy
+void unload_leaked(const char* name, int times) {
+    if (auto handle = ::dlopen(name, RTLD_NOW | RTLD_NOLOAD)) {
+        for (int i = 0; i <= times; ++i) {
+            ::dlclose(handle);
+        }
+    }
+}
+#endif
+
+}   // namespace
+
+TEST_SUITE("fast_exit") {
+    TEST_CASE("libraries aren't leaked unless marked") {
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        REQUIRE_FALSE(lib.leaks_on_exit());
+        lib.set_leak_on_exit(true);
+        REQUIRE(lib.leaks_on_exit());
+
+        // Without fast exit the mark does nothing
+        auto bar = lib.get_symbol<int>("bar");
+        lib.close();
+        REQUIRE_FALSE(bar.is_valid());
+        REQUIRE(lib.last_error().empty());
+        REQUIRE(lib.leaks_on_exit());
+    }
+
+#if REIJI_PLATFORM_POSIX
+    TEST_CASE("marked libraries skip their teardown") {
+        using clock = std::chrono::steady_clock;
+        fast_exit_scope fast_exit;
+
+        // lib3's static destructor sleeps for 250ms
+        auto start = clock::now();
+        {
+            reiji::unique_shared_lib lib {LIB3_NAME};
+            lib.set_leak_on_exit(true);
+            auto qux = lib.get_symbol<int>("qux");
+            REQUIRE(*qux == 7);
+
+            lib.close();
+            REQUIRE_FALSE(qux.is_valid());
+            REQUIRE(lib.last_error().empty());
+
+            // Moved libraries keep the mark, and leak through the destructor
+            lib.open(LIB3_NAME);
+            auto moved = std::move(lib);
+            REQUIRE(moved.leaks_on_exit());
+        }
+        REQUIRE(clock::now() - start < std::chrono::milliseconds {100});
+
+        auto handle = ::dlopen(LIB3_NAME, RTLD_NOW | RTLD_NOLOAD);
+        REQUIRE(handle != nullptr);
+        ::dlclose(handle);
+        unload_leaked(LIB3_NAME, 2);
+    }
+#endif
+
+    TEST_CASE("unmarked libraries are closed as usual") {
+        fast_exit_scope fast_exit;
+        REQUIRE(reiji::fast_exit_enabled());
+
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        auto bar = lib.get_symbol<int>("bar");
+        lib.close();
+        REQUIRE_FALSE(bar.is_valid());
+        REQUIRE(lib.last_error().empty());
+    }
+
+    TEST_CASE("close_in_order tears down marked libraries too") {
+        fast_exit_scope fast_exit;
+
+        reiji::unique_shared_lib first {LIB3_NAME};
+        reiji::unique_shared_lib second {LIB1_NAME};
+        reiji::unique_shared_lib never_opened;
+        first.set_leak_on_exit(true);
+        second.set_leak_on_exit(true);
+        auto qux = first.get_symbol<int>("qux");
+        auto bar = second.get_symbol<int>("bar");
+
+        reiji::close_in_order({&first, nullptr, &second, &never_opened});
+        REQUIRE_FALSE(qux.is_valid());
+        REQUIRE_FALSE(bar.is_valid());
+        REQUIRE(first.last_error().empty());
+        REQUIRE(second.last_error().empty());
+
+        // Nothing left to leak once they're closed
+        first.close();
+        second.close();
+    }
+}
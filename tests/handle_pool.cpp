@@ -0,0 +1,151 @@
+#include <doctest/doctest.h>
+
+#include <chrono>
+
+// clang-format off
+#include <reiji/handle_pool.hpp>
+#include <reiji/unique_shared_lib.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if REIJI_PLATFORM_POSIX
+#    include <dlfcn.h>
+#endif
+
+#if defined(__APPLE__)
+#    define LIB1_NAME "liblib1.dylib"
+#    define LIB2_NAME "liblib2.dylib"
+#    define LIB3_NAME "liblib3.dylib"
+#elif REIJI_PLATFORM_POSIX
+#    define LIB1_NAME "liblib1.so"
+#    define LIB2_NAME "liblib2.so"
+#    define LIB3_NAME "liblib3.so"
+#elif REIJI_PLATFORM_WINDOWS
+#    define LIB1_NAME "lib1.dll"
+#    define LIB2_NAME "lib2.dll"
+#    define LIB3_NAME "lib3.dll"
+#endif
+
+#if REIJI_PLATFORM_POSIX
+// Only good for warnings, dlclose is allowed to keep libraries loaded (and
+// does so under sanitizers, for example)
+static bool is_loaded(const char* name) {
+    auto handle = ::dlopen(name, RTLD_NOW | RTLD_NOLOAD);
+    if (handle) {
+        ::dlclose(handle);
+    }
+    return handle;
+}
+#endif
+
+TEST_SUITE("handle_pool") {
+    TEST_CASE("closed libraries stay loaded and keep their state") {
+        reiji::handle_pool pool {4};
+
+        auto lib = pool.open(LIB1_NAME);
+        REQUIRE(lib.last_error().empty());
+        auto increase = lib.get_symbol<int()>("increase_bar_and_return_it");
+        REQUIRE(increase != nullptr);
+        auto bar = increase();
+
+        lib.close();
+        REQUIRE_FALSE(increase.is_valid());
+        REQUIRE(pool.idle() == 1);
+
+        lib = pool.open(LIB1_NAME);
+        REQUIRE(pool.idle() == 0);
+        REQUIRE(*lib.get_symbol<int>("bar") == bar);
+    }
+
+    TEST_CASE("reopening skips static destructors and constructors") {
+        reiji::handle_pool pool {1};
+        {
+            auto lib = pool.open(LIB3_NAME);
+            REQUIRE(lib.last_error().empty());
+        }
+
+        // lib3's teardown sleeps for 250ms
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 100; ++i) {
+            auto lib = pool.open(LIB3_NAME);
+            REQUIRE(lib.get_symbol<int>("qux") != nullptr);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        REQUIRE(elapsed < std::chrono::milliseconds {100});
+    }
+
+    TEST_CASE("libraries in use are shared and not counted as idle") {
+        reiji::handle_pool pool {4};
+        auto a = pool.open(LIB1_NAME);
+        auto b = pool.open(LIB1_NAME);
+        REQUIRE(&*a.get_symbol<int>("bar") == &*b.get_symbol<int>("bar"));
+
+        a.close();
+        REQUIRE(pool.idle() == 0);
+        REQUIRE(b.get_symbol<int>("bar") != nullptr);
+        b.close();
+        REQUIRE(pool.idle() == 1);
+    }
+
+    TEST_CASE("the least recently used libraries are closed past capacity") {
+        reiji::handle_pool pool {1};
+        pool.open(LIB1_NAME).close();
+        pool.open(LIB2_NAME).close();
+        REQUIRE(pool.idle() == 1);
+#if REIJI_PLATFORM_POSIX
+        WARN_FALSE(is_loaded(LIB1_NAME));
+        WARN(is_loaded(LIB2_NAME));
+#endif
+
+        pool.set_capacity(0);
+        REQUIRE(pool.idle() == 0);
+#if REIJI_PLATFORM_POSIX
+        WARN_FALSE(is_loaded(LIB2_NAME));
+#endif
+    }
+
+    TEST_CASE("evicted libraries are closed the way they were released") {
+        using clock = std::chrono::steady_clock;
+        reiji::handle_pool pool {1};
+        {
+            auto lib = pool.open(LIB3_NAME);
+            REQUIRE(lib.last_error().empty());
+            lib.close(reiji::close_mode::deferred);
+        }
+
+        // lib3's teardown sleeps for 250ms, which the reclaimer waits out.
+        // Nothing else may go through the loader meanwhile, as it stays
+        // locked while the teardown runs.
+        auto start = clock::now();
+        pool.set_capacity(0);
+        REQUIRE(clock::now() - start < std::chrono::milliseconds {100});
+        REQUIRE(pool.idle() == 0);
+        reiji::drain_deferred_closes();
+    }
+
+    TEST_CASE("libraries outliving their pool are closed normally") {
+        reiji::unique_shared_lib lib;
+        {
+            reiji::handle_pool pool {4};
+            pool.open(LIB2_NAME).close();
+            lib = pool.open(LIB1_NAME);
+        }
+        REQUIRE(lib.get_symbol<int>("bar") != nullptr);
+#if REIJI_PLATFORM_POSIX
+        WARN_FALSE(is_loaded(LIB2_NAME));
+#endif
+
+        lib.close();
+        REQUIRE(lib.last_error().empty());
+#if REIJI_PLATFORM_POSIX
+        WARN_FALSE(is_loaded(LIB1_NAME));
+#endif
+    }
+
+    TEST_CASE("failed opens aren't pooled") {
+        reiji::handle_pool pool {4};
+        auto lib = pool.open("this_library_does_not_exist");
+        REQUIRE_FALSE(lib.last_error().empty());
+        REQUIRE(pool.idle() == 0);
+    }
+}
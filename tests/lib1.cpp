@@ -9,4 +9,10 @@ int bar = 5;
 EXPORT int increase_bar_and_return_it() {
     return ++bar;
 }
+
+extern EXPORT const int table[4];
+const int table[4] = {1, 2, 3, 4};
+
+// Also defined by lib2, for lookups across several libraries
+EXPORT int layer = 1;
 }
@@ -4,4 +4,6 @@ extern "C" {
 
 EXPORT int baz = 5;
 
+EXPORT int layer = 2;
+
 }
@@ -0,0 +1,27 @@
+#include "export.hpp"
+#include <chrono>
+#include <thread>
+
+namespace {
+
+// Stands in for a plugin with expensive teardown, so tests can tell whether
+// unloading happened on the calling thread or not
+struct slow_teardown {
+    ~slow_teardown() {
+        std::this_thread::sleep_for(std::chrono::milliseconds {250});
+    }
+} teardown;
+
+}   // namespace
+
+extern "C" {
+
+// From lib2, so that lib3 has a dependency for prefetch tests to find
+IMPORT extern int baz;
+
+EXPORT int qux = 7;
+
+EXPORT int qux_plus_baz() {
+    return qux + baz;
+}
+}
@@ -0,0 +1,8 @@
+#include "export.hpp"
+
+extern "C" {
+
+// Only opened by the test that keeps a library around until exit, so that it
+// staying loaded doesn't get in the way of other tests
+EXPORT int quux = 9;
+}
@@ -0,0 +1,98 @@
+#include <doctest/doctest.h>
+
+#include "temp_dir.hpp"
+
+// clang-format off
+#include <reiji/library_resolver.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if defined(__APPLE__)
+#    define LIB1_NAME "liblib1.dylib"
+#    define FOO_NAME  "libfoo.dylib"
+#elif REIJI_PLATFORM_POSIX
+#    define LIB1_NAME "liblib1.so"
+#    define FOO_NAME  "libfoo.so"
+#elif REIJI_PLATFORM_WINDOWS
+#    define LIB1_NAME "lib1.dll"
+#    define FOO_NAME  "foo.dll"
+#endif
+
+namespace fs = std::filesystem;
+
+TEST_SUITE("library_resolver") {
+    TEST_CASE("bare names resolve using the platform's naming rules") {
+        reiji::library_resolver resolver {
+            {"/nonexistent/reiji/dir", REIJI_TEST_LIB_DIR}};
+        auto path = resolver.resolve("lib1");
+        REQUIRE(path.has_value());
+        REQUIRE(*path == fs::path {REIJI_TEST_LIB_DIR} / LIB1_NAME);
+        REQUIRE(resolver.resolve(LIB1_NAME) == path);
+        REQUIRE_FALSE(resolver.resolve("reiji_no_such_library").has_value());
+    }
+
+    TEST_CASE("earlier directories take precedence") {
+        temp_dir first {"reiji-resolver-"}, second {"reiji-resolver-"};
+        first.touch(FOO_NAME);
+        second.touch(FOO_NAME);
+
+        reiji::library_resolver resolver {{first.path, second.path}};
+        REQUIRE(resolver.resolve("foo") == first.path / FOO_NAME);
+    }
+
+    TEST_CASE("only files count as matches") {
+        temp_dir first {"reiji-resolver-"}, second {"reiji-resolver-"};
+        fs::create_directory(first.path / FOO_NAME);
+        second.touch(FOO_NAME);
+
+        reiji::library_resolver resolver {{first.path, second.path}};
+        REQUIRE(resolver.resolve("foo") == second.path / FOO_NAME);
+
+#if REIJI_PLATFORM_POSIX
+        // Symlinks count by what they point at
+        temp_dir links {"reiji-resolver-"};
+        fs::create_directory_symlink(first.path / FOO_NAME,
+                                     links.path / "libdir.so");
+        fs::create_symlink(second.path / FOO_NAME, links.path / "libfile.so");
+        fs::create_symlink(links.path / "missing", links.path / "libgone.so");
+
+        reiji::library_resolver link_resolver {{links.path}};
+        REQUIRE_FALSE(link_resolver.resolve("libdir.so").has_value());
+        REQUIRE(link_resolver.resolve("libfile.so")
+                == links.path / "libfile.so");
+        REQUIRE_FALSE(link_resolver.resolve("libgone.so").has_value());
+#endif
+    }
+
+    TEST_CASE("listings are cached until invalidated") {
+        temp_dir dir {"reiji-resolver-"};
+        reiji::library_resolver resolver {{dir.path}};
+        REQUIRE_FALSE(resolver.resolve("foo").has_value());
+
+        dir.touch(FOO_NAME);
+        REQUIRE_FALSE(resolver.resolve("foo").has_value());
+        resolver.invalidate(dir.path);
+        REQUIRE(resolver.resolve("foo") == dir.path / FOO_NAME);
+    }
+
+#if defined(__linux__)
+    TEST_CASE("watching resolvers notice new files on their own") {
+        temp_dir dir {"reiji-resolver-"};
+        reiji::library_resolver resolver {
+            {dir.path}, reiji::resolver_invalidation::watch};
+        REQUIRE_FALSE(resolver.resolve("foo").has_value());
+
+        dir.touch(FOO_NAME);
+        REQUIRE(resolver.resolve("foo") == dir.path / FOO_NAME);
+    }
+#endif
+
+    TEST_CASE("open uses resolved paths") {
+        reiji::library_resolver resolver {{REIJI_TEST_LIB_DIR}};
+        auto lib = resolver.open("lib1");
+        REQUIRE(lib.get_symbol<int>("bar") != nullptr);
+
+        auto missing = resolver.open("reiji_no_such_library");
+        REQUIRE_FALSE(missing.last_error().empty());
+    }
+}
@@ -0,0 +1,96 @@
+#include <doctest/doctest.h>
+
+#include <utility>
+
+// clang-format off
+#include <reiji/library_set.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if defined(__APPLE__)
+#    define LIB1_NAME "liblib1.dylib"
+#    define LIB2_NAME "liblib2.dylib"
+#    define LIB3_NAME "liblib3.dylib"
+#elif REIJI_PLATFORM_POSIX
+#    define LIB1_NAME "liblib1.so"
+#    define LIB2_NAME "liblib2.so"
+#    define LIB3_NAME "liblib3.so"
+#elif REIJI_PLATFORM_WINDOWS
+#    define LIB1_NAME "lib1.dll"
+#    define LIB2_NAME "lib2.dll"
+#    define LIB3_NAME "lib3.dll"
+#endif
+
+TEST_SUITE("library_set") {
+    TEST_CASE("an empty set finds nothing") {
+        reiji::library_set set;
+        REQUIRE(set.empty());
+        REQUIRE(set.find_first<int>("bar") == nullptr);
+        REQUIRE(set.find_all<int>("bar").empty());
+        REQUIRE(set.provider("bar") == nullptr);
+    }
+
+    TEST_CASE("members are searched in order of precedence") {
+        using namespace reiji::literals;
+
+        reiji::library_set set;
+        auto& lib3 = set.add(reiji::unique_shared_lib {LIB3_NAME});
+        auto& lib1 = set.add(reiji::unique_shared_lib {LIB1_NAME});
+        auto& lib2 = set.add(reiji::unique_shared_lib {LIB2_NAME}, 1);
+        REQUIRE(set.size() == 3);
+
+        auto layer = set.find_first<int>("layer"_sym);
+        REQUIRE(layer != nullptr);
+        REQUIRE(*layer == 2);
+        REQUIRE(set.provider("layer") == &lib2);
+
+        // Equal precedences keep the order members were added in, and lib3
+        // only gets layer from its dependency so it doesn't count
+        auto all = set.find_all<int>("layer");
+        REQUIRE(all.size() == 2);
+        REQUIRE(*all[0] == 2);
+        REQUIRE(*all[1] == 1);
+
+        REQUIRE(set.provider("qux") == &lib3);
+        REQUIRE(set.find_first<int>("bar") != nullptr);
+
+        REQUIRE(set.remove(lib2));
+        REQUIRE_FALSE(set.remove(lib2));
+        REQUIRE(*set.find_first<int>("layer") == 1);
+        REQUIRE(set.provider("layer") == &lib1);
+    }
+
+    TEST_CASE("misses don't leave errors behind") {
+        reiji::library_set set;
+        auto& lib1 = set.add(reiji::unique_shared_lib {LIB1_NAME});
+        auto& lib2 = set.add(reiji::unique_shared_lib {LIB2_NAME});
+
+        REQUIRE(set.find_first<int>("not_a_real_symbol") == nullptr);
+        REQUIRE(set.find_all<int>("not_a_real_symbol").empty());
+        REQUIRE(lib1.last_error().empty());
+        REQUIRE(lib2.last_error().empty());
+    }
+
+    TEST_CASE("reopened members are searched by what they are now") {
+        reiji::library_set set;
+        auto& lib = set.add(reiji::unique_shared_lib {LIB1_NAME});
+        REQUIRE(set.provider("bar") == &lib);
+
+        lib.open(LIB2_NAME);
+        REQUIRE(set.provider("bar") == nullptr);
+        REQUIRE(set.provider("baz") == &lib);
+
+        lib.close();
+        REQUIRE(set.provider("baz") == nullptr);
+    }
+
+    TEST_CASE("symbols outlive a moved set") {
+        reiji::library_set set;
+        set.add(reiji::unique_shared_lib {LIB1_NAME});
+        auto bar = set.find_first<int>("bar");
+
+        auto other = std::move(set);
+        REQUIRE(bar != nullptr);
+        REQUIRE(&*bar == &*other.provider("bar")->get_symbol<int>("bar"));
+    }
+}
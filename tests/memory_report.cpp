@@ -0,0 +1,96 @@
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+// clang-format off
+#include <reiji/memory_report.hpp>
+#include <reiji/unique_shared_lib.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if defined(__APPLE__)
+#    define LIB1_NAME "liblib1.dylib"
+#elif REIJI_PLATFORM_POSIX
+#    define LIB1_NAME "liblib1.so"
+#elif REIJI_PLATFORM_WINDOWS
+#    define LIB1_NAME "lib1.dll"
+#endif
+
+TEST_SUITE("memory_report") {
+    TEST_CASE("closed libraries take up no memory") {
+        reiji::unique_shared_lib lib;
+        auto report = lib.memory_footprint();
+        REQUIRE(report.segments.empty());
+        REQUIRE(report.total.size == 0);
+    }
+
+#if defined(__linux__)
+    TEST_CASE("libraries report each of their segments") {
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        auto bar = lib.get_symbol<int>("bar");
+        REQUIRE(bar != nullptr);
+        *bar += 0;
+
+        auto report = lib.memory_footprint();
+        REQUIRE_FALSE(report.segments.empty());
+
+        std::size_t size = 0;
+        bool found_code  = false;
+        bool found_bar   = false;
+        auto bar_address = reinterpret_cast<std::uintptr_t>(&*bar);
+        for (auto& segment : report.segments) {
+            REQUIRE(segment.start < segment.end);
+            REQUIRE(segment.usage.size == segment.end - segment.start);
+            size += segment.usage.size;
+            found_code |= segment.executable;
+            if (segment.start <= bar_address && bar_address < segment.end) {
+                found_bar = true;
+                REQUIRE(segment.writable);
+                REQUIRE(segment.usage.rss > 0);
+            }
+        }
+        REQUIRE(found_code);
+        REQUIRE(found_bar);
+        REQUIRE(report.total.size == size);
+        REQUIRE(report.total.rss <= report.total.size);
+    }
+
+    TEST_CASE("the process wide summary covers open libraries") {
+        auto before = reiji::open_libraries_memory_usage();
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        auto footprint = lib.memory_footprint();
+        auto during    = reiji::open_libraries_memory_usage();
+        REQUIRE(during.size == before.size + footprint.total.size);
+
+        // Opening it again doesn't count it twice
+        reiji::unique_shared_lib again {LIB1_NAME};
+        REQUIRE(reiji::open_libraries_memory_usage().size == during.size);
+
+        lib.close();
+        again.close();
+        REQUIRE(reiji::open_libraries_memory_usage().size == before.size);
+    }
+
+    TEST_CASE("libraries may be closed while the summary is taken") {
+        reiji::unique_shared_lib kept {LIB1_NAME};
+        auto footprint = kept.memory_footprint();
+
+        std::atomic<bool> done {false};
+        std::thread churn {[&] {
+            while (not done) {
+                reiji::unique_shared_lib lib {LIB1_NAME};
+                lib.close();
+            }
+        }};
+        for (int i = 0; i < 200; ++i) {
+            auto usage = reiji::open_libraries_memory_usage();
+            REQUIRE(usage.size >= footprint.total.size);
+        }
+        done = true;
+        churn.join();
+    }
+#endif
+}
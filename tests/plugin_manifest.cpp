@@ -0,0 +1,156 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+
+#include "temp_dir.hpp"
+
+// clang-format off
+#include <reiji/plugin_manifest.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if defined(__APPLE__)
+#    define LIB1_NAME "liblib1.dylib"
+#    define LIB2_NAME "liblib2.dylib"
+#    define LIB3_NAME "liblib3.dylib"
+#elif REIJI_PLATFORM_POSIX
+#    define LIB1_NAME "liblib1.so"
+#    define LIB2_NAME "liblib2.so"
+#    define LIB3_NAME "liblib3.so"
+#elif REIJI_PLATFORM_WINDOWS
+#    define LIB1_NAME "lib1.dll"
+#    define LIB2_NAME "lib2.dll"
+#    define LIB3_NAME "lib3.dll"
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A scratch directory holding copies of the test libraries and a file that
+// isn't one, removed at the end of the test
+struct plugin_dir {
+    plugin_dir() : path {root.path / "plugins"} {
+        fs::create_directories(path);
+
+        for (auto name : {LIB1_NAME, LIB3_NAME}) {
+            fs::copy_file(fs::path {REIJI_TEST_LIB_DIR} / name, path / name);
+        }
+        std::ofstream {path / "README"} << "not a library\n";
+    }
+
+    fs::path cache() const { return root.path / "manifest"; }
+
+    temp_dir root {"reiji-manifest-"};
+    fs::path path;
+};
+
+bool contains(const std::vector<std::string>& list, const std::string& s) {
+    return std::find(list.begin(), list.end(), s) != list.end();
+}
+
+}   // namespace
+
+TEST_SUITE("plugin_manifest") {
+    TEST_CASE("a cold manifest parses every file") {
+        plugin_dir dir;
+        reiji::plugin_manifest manifest {dir.cache()};
+        REQUIRE(manifest.entries().empty());
+
+        REQUIRE(manifest.refresh(dir.path) == 3);
+        REQUIRE(manifest.entries().size() == 3);
+
+        auto readme = manifest.find(dir.path / "README");
+        REQUIRE(readme);
+        REQUIRE(readme->size == 14);
+        REQUIRE(manifest.find(dir.path / "nope") == nullptr);
+
+        auto lib1 = manifest.find(dir.path / LIB1_NAME);
+        REQUIRE(lib1);
+        REQUIRE(lib1->is_library);
+        REQUIRE(lib1->size == fs::file_size(dir.path / LIB1_NAME));
+
+#if REIJI_PLATFORM_ELF
+        REQUIRE_FALSE(readme->is_library);
+        REQUIRE(lib1->exports("bar"));
+        REQUIRE_FALSE(lib1->exports("ba"));
+        REQUIRE_FALSE(lib1->exports("baz"));
+        REQUIRE(contains(manifest.find(dir.path / LIB3_NAME)->needed,
+                         LIB2_NAME));
+
+        auto plugins = manifest.find_plugins({"qux", "qux_plus_baz"});
+        REQUIRE(plugins.size() == 1);
+        REQUIRE(plugins[0] == dir.path / LIB3_NAME);
+        REQUIRE(manifest.find_plugins({"bar", "qux"}).empty());
+#endif
+        REQUIRE(manifest.find_plugins({}).size() == 2);
+    }
+
+    TEST_CASE("a warm manifest parses nothing") {
+        plugin_dir dir;
+        {
+            reiji::plugin_manifest manifest {dir.cache()};
+            manifest.refresh(dir.path);
+            REQUIRE(manifest.save());
+        }
+
+        reiji::plugin_manifest manifest {dir.cache()};
+        REQUIRE(manifest.entries().size() == 3);
+        auto lib1 = *manifest.find(dir.path / LIB1_NAME);
+
+        REQUIRE(manifest.refresh(dir.path) == 0);
+        auto& again = *manifest.find(dir.path / LIB1_NAME);
+        REQUIRE(again.mtime == lib1.mtime);
+        REQUIRE(again.build_id == lib1.build_id);
+        REQUIRE(again.export_names == lib1.export_names);
+        REQUIRE(again.export_offsets == lib1.export_offsets);
+        REQUIRE(again.needed == lib1.needed);
+    }
+
+    TEST_CASE("only changed files get parsed again") {
+        plugin_dir dir;
+        reiji::plugin_manifest manifest {dir.cache()};
+        manifest.refresh(dir.path);
+
+        // lib1 turns into lib2, lib3 goes away and a new file shows up
+        fs::copy_file(fs::path {REIJI_TEST_LIB_DIR} / LIB2_NAME,
+                      dir.path / LIB1_NAME,
+                      fs::copy_options::overwrite_existing);
+        fs::remove(dir.path / LIB3_NAME);
+        fs::copy_file(fs::path {REIJI_TEST_LIB_DIR} / LIB2_NAME,
+                      dir.path / LIB2_NAME);
+
+        REQUIRE(manifest.refresh(dir.path) == 3);
+        REQUIRE(manifest.entries().size() == 3);
+        REQUIRE(manifest.find(dir.path / LIB3_NAME) == nullptr);
+#if REIJI_PLATFORM_ELF
+        REQUIRE(manifest.find(dir.path / LIB1_NAME)->exports("baz"));
+        REQUIRE(manifest.find_plugins({"baz"}).size() == 2);
+#endif
+    }
+
+    TEST_CASE("entries from other directories are left alone") {
+        plugin_dir first, second;
+        reiji::plugin_manifest manifest {first.cache()};
+        manifest.refresh(first.path);
+        manifest.refresh(second.path);
+        REQUIRE(manifest.entries().size() == 6);
+
+        fs::remove(second.path / LIB1_NAME);
+        REQUIRE(manifest.refresh(second.path) == 1);
+        REQUIRE(manifest.find(first.path / LIB1_NAME));
+    }
+
+    TEST_CASE("unreadable cache files make for an empty manifest") {
+        plugin_dir dir;
+        std::ofstream {dir.cache()} << "REIJIPM1 but then garbage";
+        REQUIRE(reiji::plugin_manifest {dir.cache()}.entries().empty());
+
+        // Truncated in the middle of an entry
+        reiji::plugin_manifest manifest {dir.cache()};
+        manifest.refresh(dir.path);
+        REQUIRE(manifest.save());
+        fs::resize_file(dir.cache(), fs::file_size(dir.cache()) - 4);
+        REQUIRE(reiji::plugin_manifest {dir.cache()}.entries().empty());
+    }
+}
@@ -0,0 +1,56 @@
+#include <doctest/doctest.h>
+
+// clang-format off
+#include <reiji/plugin_scanner.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if defined(__APPLE__)
+#    define LIB1_NAME "liblib1.dylib"
+#    define LIB2_NAME "liblib2.dylib"
+#elif REIJI_PLATFORM_POSIX
+#    define LIB1_NAME "liblib1.so"
+#    define LIB2_NAME "liblib2.so"
+#elif REIJI_PLATFORM_WINDOWS
+#    define LIB1_NAME "lib1.dll"
+#    define LIB2_NAME "lib2.dll"
+#endif
+
+TEST_SUITE("plugin scanning") {
+#if REIJI_PLATFORM_ELF
+    TEST_CASE("find_plugins only accepts libraries defining every export") {
+        auto plugins = reiji::find_plugins(
+            REIJI_TEST_LIB_DIR, {"bar", "increase_bar_and_return_it"});
+        REQUIRE(plugins.size() == 1);
+        REQUIRE(plugins[0].filename() == LIB1_NAME);
+
+        // lib3 uses baz, but only lib2 defines it
+        plugins = reiji::find_plugins(REIJI_TEST_LIB_DIR, {"baz"});
+        REQUIRE(plugins.size() == 1);
+        REQUIRE(plugins[0].filename() == LIB2_NAME);
+
+        REQUIRE(reiji::find_plugins(REIJI_TEST_LIB_DIR, {"bar", "baz"})
+                    .empty());
+    }
+#endif
+
+    TEST_CASE("load_plugins binds the requested symbols") {
+        auto plugins = reiji::load_plugins<int, int()>(
+            REIJI_TEST_LIB_DIR, {"bar", "increase_bar_and_return_it"});
+        REQUIRE(plugins.size() == 1);
+        REQUIRE(plugins[0].path.filename() == LIB1_NAME);
+
+        auto& [bar, increase_bar] = plugins[0].symbols;
+        auto before               = *bar;
+        REQUIRE(increase_bar() == before + 1);
+        REQUIRE(*bar == before + 1);
+
+        plugins[0].library.close();
+        REQUIRE_FALSE(bar.is_valid());
+        REQUIRE_FALSE(increase_bar.is_valid());
+    }
+
+    TEST_CASE("find_plugins copes with missing directories") {
+        REQUIRE(reiji::find_plugins("/nonexistent/reiji/dir", {"bar"}).empty());
+    }
+}
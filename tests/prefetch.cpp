@@ -0,0 +1,55 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+
+// clang-format off
+#include <reiji/prefetch.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+#if REIJI_PLATFORM_ELF
+#    include <dlfcn.h>
+
+TEST_SUITE("prefetch") {
+    static bool contains(const std::vector<reiji::fs::path>& files,
+                         const char* filename) {
+        return std::any_of(files.begin(), files.end(), [&](auto& file) {
+            return file.filename() == filename;
+        });
+    }
+
+    TEST_CASE("prefetch starts with the library it was given") {
+        auto path  = reiji::fs::path {REIJI_TEST_LIB_DIR} / "liblib1.so";
+        auto files = reiji::prefetch(path);
+        REQUIRE_FALSE(files.empty());
+        REQUIRE(files.front() == path);
+    }
+
+    TEST_CASE("prefetch follows DT_NEEDED but skips loaded libraries") {
+        // lib3 links against lib2, and both obviously need libc. Whether
+        // lib2 is already loaded depends on what ran before us in this
+        // process.
+        auto lib2        = ::dlopen("liblib2.so", RTLD_NOW | RTLD_NOLOAD);
+        auto lib2_loaded = lib2 != nullptr;
+        auto files = reiji::prefetch(reiji::fs::path {REIJI_TEST_LIB_DIR}
+                                     / "liblib3.so");
+        if (lib2) {
+            ::dlclose(lib2);
+        }
+
+        REQUIRE(contains(files, "liblib3.so"));
+        REQUIRE(contains(files, "liblib2.so") != lib2_loaded);
+        REQUIRE_FALSE(contains(files, "libc.so.6"));
+    }
+
+    TEST_CASE("prefetch ignores files that don't exist") {
+        REQUIRE(reiji::prefetch("/nonexistent/libreiji_nope.so").empty());
+    }
+
+    TEST_CASE("prefetch_async does the same work as prefetch") {
+        auto path   = reiji::fs::path {REIJI_TEST_LIB_DIR} / "liblib3.so";
+        auto future = reiji::prefetch_async(path);
+        REQUIRE(future.get() == reiji::prefetch(path));
+    }
+}
+#endif
@@ -0,0 +1,115 @@
+#include <doctest/doctest.h>
+
+#include <string>
+#include <vector>
+
+// clang-format off
+#include <reiji/library_set.hpp>
+#include <reiji/static_module.hpp>
+#include <reiji/unique_shared_lib.hpp>
+#include <reiji/detail/push_platform_detection_macros.hpp>
+// clang-format on
+
+namespace {
+
+int answer = 42;
+const int primes[4] = {2, 3, 5, 7};
+
+int twice(int x) {
+    return x * 2;
+}
+
+const reiji::static_symbol symbols[] = {
+    {"answer", &answer},
+    {"primes", &primes},
+    {"twice", &twice},
+};
+reiji::static_module module {"libstatic_test_module.so", symbols};
+
+}   // namespace
+
+TEST_SUITE("static_module") {
+    TEST_CASE("registered modules open without the platform loader") {
+        using namespace reiji::literals;
+
+        reiji::unique_shared_lib lib {"libstatic_test_module.so"};
+        REQUIRE(lib.last_error().empty());
+
+        auto a = lib.get_symbol<int>("answer");
+        REQUIRE(a != nullptr);
+        REQUIRE(&*a == &answer);
+        REQUIRE(&*lib.get_symbol<int>("answer"_sym) == &answer);
+
+        auto f = lib.get_symbol<int(int)>("twice");
+        REQUIRE(f != nullptr);
+        REQUIRE(f(21) == 42);
+
+        auto p = lib.get_symbol<const int[]>("primes");
+        REQUIRE(p.size() == 4);
+        REQUIRE(p[3] == 7);
+
+        REQUIRE(lib.get_symbol<int>("missing") == nullptr);
+        REQUIRE(lib.last_error()
+                == "Module 'libstatic_test_module.so' has no symbol "
+                   "'missing'.");
+
+        lib.close();
+        REQUIRE_FALSE(a.is_valid());
+        REQUIRE(lib.get_symbol<int>("answer") == nullptr);
+    }
+
+    TEST_CASE("the main program can still be opened") {
+        // dlopen(NULL) hands out the main program, the registry lookup
+        // has to cope with the null name
+        reiji::unique_shared_lib self {static_cast<const char*>(nullptr)};
+#if REIJI_PLATFORM_POSIX
+        REQUIRE(self.last_error().empty());
+#endif
+    }
+
+    TEST_CASE("modules keep their own copy of the name") {
+        std::string name = "libstatic_renamed_module.so";
+        reiji::static_module renamed {name.c_str(), symbols};
+        name.assign(name.size(), 'x');
+
+        reiji::unique_shared_lib lib {"libstatic_renamed_module.so"};
+        REQUIRE(lib.last_error().empty());
+        REQUIRE(*lib.get_symbol<int>("answer") == 42);
+    }
+
+    TEST_CASE("static modules take part in library sets") {
+        reiji::library_set set;
+        auto& lib =
+            set.add(reiji::unique_shared_lib {"libstatic_test_module.so"});
+        REQUIRE(set.provider("twice") == &lib);
+        REQUIRE(set.provider("missing") == nullptr);
+        REQUIRE(lib.last_error().empty());
+    }
+
+    TEST_CASE("big symbol tables are found through the perfect hash") {
+        std::vector<std::string> names;
+        std::vector<int> values(5000);
+        std::vector<reiji::static_symbol> table;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            names.push_back("symbol_" + std::to_string(i));
+        }
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            table.push_back({names[i].c_str(), &values[i]});
+        }
+
+        {
+            reiji::static_module big {"big_module", table.data(), table.size()};
+            reiji::unique_shared_lib lib {"big_module"};
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                auto sym = lib.get_symbol<int>(names[i]);
+                REQUIRE(&*sym == &values[i]);
+            }
+            REQUIRE(lib.get_symbol<int>("symbol_5000") == nullptr);
+            REQUIRE(lib.get_symbol<int>("symbol_") == nullptr);
+        }
+
+        // Unregistered along with the module object
+        reiji::unique_shared_lib lib {"big_module"};
+        REQUIRE_FALSE(lib.last_error().empty());
+    }
+}
@@ -37,4 +37,21 @@ TEST_SUITE("Symbol tests") {
         REQUIRE_FALSE(s1 <= s2);
         REQUIRE_FALSE(s1 >= s2);
     }
+
+    TEST_CASE("Array symbols upon default construction") {
+        reiji::symbol<int[]> unbounded;
+        reiji::symbol<const int[3]> bounded;
+
+        REQUIRE_FALSE(unbounded.is_valid());
+        REQUIRE(unbounded.size() == 0);
+        REQUIRE(unbounded.empty());
+        REQUIRE(unbounded == nullptr);
+        REQUIRE_THROWS_AS(unbounded.data(), reiji::bad_symbol_access);
+
+        REQUIRE_FALSE(bounded.is_valid());
+        REQUIRE(bounded.size() == 0);
+        REQUIRE(bounded.empty());
+        REQUIRE_THROWS_AS(bounded[0], reiji::bad_symbol_access);
+        REQUIRE_THROWS_AS(bounded.begin(), reiji::bad_symbol_access);
+    }
 }
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <system_error>
+
+#if defined(_WIN32)
+#    include <process.h>   // _getpid
+#else
+#    include <unistd.h>   // getpid
+#endif
+
+// A scratch directory that gets removed at the end of the test.
+//
+// ctest runs every test case in a process of its own, several at a time, so
+// the name has to be unique across processes: it's made of the pid and a
+// random part, and a directory that already exists is never reused.
+struct temp_dir {
+    explicit temp_dir(const char* prefix)
+        : temp_dir {prefix, std::filesystem::temp_directory_path()} {}
+    temp_dir(const char* prefix, const std::filesystem::path& parent) {
+#if defined(_WIN32)
+        auto pid = static_cast<std::uint64_t>(::_getpid());
+#else
+        auto pid = static_cast<std::uint64_t>(::getpid());
+#endif
+        std::mt19937_64 random {
+            std::random_device {}()
+            ^ static_cast<std::uint64_t>(
+                std::chrono::steady_clock::now().time_since_epoch().count())};
+
+        for (;;) {
+            path = parent
+                   / (prefix + std::to_string(pid) + "-"
+                      + std::to_string(random()));
+            // create_directory says false when the directory was already there
+            if (std::filesystem::create_directory(path)) {
+                break;
+            }
+        }
+    }
+    ~temp_dir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+
+    temp_dir(const temp_dir&) = delete;
+    temp_dir& operator=(const temp_dir&) = delete;
+
+    void touch(const char* name) const { std::ofstream {path / name}; }
+
+    std::filesystem::path path;
+};
@@ -1,5 +1,9 @@
 #include <doctest/doctest.h>
 
+#include <chrono>
+#include <cstring>
+#include <vector>
+
 // clang-format off
 #include <reiji/unique_shared_lib.hpp>
 #include <reiji/detail/push_platform_detection_macros.hpp>
@@ -8,14 +12,28 @@
 #if defined(__APPLE__)
 #    define LIB1_NAME "liblib1.dylib"
 #    define LIB2_NAME "liblib2.dylib"
+#    define LIB3_NAME "liblib3.dylib"
+#    define LIB4_NAME "liblib4.dylib"
 #elif REIJI_PLATFORM_POSIX
 #    define LIB1_NAME "liblib1.so"
 #    define LIB2_NAME "liblib2.so"
+#    define LIB3_NAME "liblib3.so"
+#    define LIB4_NAME "liblib4.so"
 #elif REIJI_PLATFORM_WINDOWS
 #    define LIB1_NAME "lib1.dll"
 #    define LIB2_NAME "lib2.dll"
+#    define LIB3_NAME "lib3.dll"
+#    define LIB4_NAME "lib4.dll"
 #endif
 
+namespace {
+
+// Constructed before the reclaimer exists, so it gets destroyed after the
+// reclaimer has been shut down at exit
+reiji::unique_shared_lib deferred_at_exit;
+
+}   // namespace
+
 TEST_SUITE("unique_shared_lib behaviour") {
     TEST_CASE("unique_shared_lib behaves sanely after default construction") {
         reiji::unique_shared_lib lib;
@@ -49,4 +67,150 @@ TEST_SUITE("unique_shared_lib behaviour") {
         REQUIRE_FALSE(bar1 == bar2);
         REQUIRE(bar1 != bar2);
     }
+
+    TEST_CASE("deferred close invalidates symbols right away") {
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        auto bar = lib.get_symbol<int>("bar");
+        REQUIRE(bar.is_valid());
+        lib.close(reiji::close_mode::deferred);
+        REQUIRE_FALSE(bar.is_valid());
+        REQUIRE(lib.last_error().empty());
+        reiji::drain_deferred_closes();
+
+        lib.open(LIB1_NAME);
+        REQUIRE(lib.get_symbol<int>("bar") != nullptr);
+    }
+
+    TEST_CASE("deferred close keeps library teardown off the caller") {
+        using clock = std::chrono::steady_clock;
+
+        // lib3's static destructor sleeps for 250ms
+        auto closing_time = [](reiji::close_mode mode) {
+            reiji::unique_shared_lib lib {LIB3_NAME};
+            REQUIRE(lib.get_symbol<int>("qux") != nullptr);
+            auto start = clock::now();
+            lib.close(mode);
+            return clock::now() - start;
+        };
+
+        REQUIRE(closing_time(reiji::close_mode::immediate)
+                >= std::chrono::milliseconds {250});
+        REQUIRE(closing_time(reiji::close_mode::deferred)
+                < std::chrono::milliseconds {100});
+        reiji::drain_deferred_closes();
+    }
+
+    TEST_CASE("deferred closes still work while the process exits") {
+        deferred_at_exit.open(LIB4_NAME);
+        deferred_at_exit.set_close_mode(reiji::close_mode::deferred);
+        REQUIRE(*deferred_at_exit.get_symbol<int>("quux") == 9);
+
+        // Makes sure the reclaimer is up and running by the time the
+        // library above is destroyed
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        lib.close(reiji::close_mode::deferred);
+        reiji::drain_deferred_closes();
+    }
+
+    TEST_CASE("implicit closes respect the close mode") {
+        reiji::unique_shared_lib lib {LIB3_NAME};
+        lib.set_close_mode(reiji::close_mode::deferred);
+        REQUIRE(lib.get_close_mode() == reiji::close_mode::deferred);
+        auto qux = lib.get_symbol<int>("qux");
+        REQUIRE(*qux == 7);
+
+        // Move assignment closes the old library through close()
+        lib = reiji::unique_shared_lib {};
+        REQUIRE_FALSE(qux.is_valid());
+        reiji::drain_deferred_closes();
+    }
+
+    TEST_CASE("symbols stay tied to their library when moved") {
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        std::vector<reiji::symbol<int>> symbols;
+        for (int i = 0; i < 20; ++i) {
+            symbols.push_back(lib.get_symbol<int>("bar"));
+        }
+        reiji::symbol<int> moved {std::move(symbols[3])};
+        swap(symbols[0], symbols[1]);
+        REQUIRE(moved.is_valid());
+
+        reiji::unique_shared_lib other {std::move(lib)};
+        REQUIRE(moved.shares_origin_with(other.get_symbol<int>("bar")));
+
+        other.close();
+        REQUIRE_FALSE(moved.is_valid());
+        for (auto& sym : symbols) {
+            REQUIRE_FALSE(sym.is_valid());
+        }
+    }
+
+    TEST_CASE("exported arrays are viewed in place") {
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        auto table = lib.get_symbol<const int[4]>("table");
+        REQUIRE(table.is_valid());
+        REQUIRE(table.size() == 4);
+        REQUIRE(table[2] == 3);
+
+        int sum = 0;
+        for (auto x : table) {
+            sum += x;
+        }
+        REQUIRE(sum == 10);
+
+#if defined(__GLIBC__)
+        auto unbounded = lib.get_symbol<const int[]>("table");
+        REQUIRE(unbounded.size() == 4);
+        REQUIRE(unbounded.data() == table.data());
+
+        REQUIRE(lib.get_symbol<const int[5]>("table") == nullptr);
+        REQUIRE_FALSE(lib.last_error().empty());
+#endif
+
+        lib.close();
+        REQUIRE_FALSE(table.is_valid());
+        REQUIRE(table.size() == 0);
+        REQUIRE(table.empty());
+        REQUIRE_THROWS_AS(table[0], reiji::bad_symbol_access);
+    }
+
+    TEST_CASE("names hashed at compile time find the same symbols") {
+        using namespace reiji::literals;
+
+        constexpr auto bar_name = "bar"_sym;
+        static_assert(bar_name.hash == 0x0b8860ba);
+        static_assert(bar_name.length == 3);
+
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        auto bar        = lib.get_symbol<int>("bar");
+        auto hashed_bar = lib.get_symbol<int>(bar_name);
+        REQUIRE(hashed_bar.is_valid());
+        REQUIRE(&*hashed_bar == &*bar);
+
+        auto increase = lib.get_symbol<int()>("increase_bar_and_return_it"_sym);
+        REQUIRE(increase() == *bar);
+
+        auto table = lib.get_symbol<const int[4]>("table"_sym);
+        REQUIRE(table[3] == 4);
+
+        REQUIRE(lib.get_symbol<int>("reiji_no_such_symbol"_sym) == nullptr);
+        REQUIRE_FALSE(lib.last_error().empty());
+
+        lib.close();
+        REQUIRE(lib.get_symbol<int>(bar_name) == nullptr);
+    }
+
+    TEST_CASE("names in char buffers are hashed up to their null") {
+        constexpr reiji::hashed_name literal {"bar"};
+        static_assert(literal.length == 3);
+
+        char buffer[64] = {};
+        std::strcpy(buffer, "bar");
+        reiji::hashed_name from_buffer {buffer};
+        REQUIRE(from_buffer.length == 3);
+        REQUIRE(from_buffer.hash == literal.hash);
+
+        reiji::unique_shared_lib lib {LIB1_NAME};
+        REQUIRE(lib.get_symbol<int>(from_buffer).is_valid());
+    }
 }